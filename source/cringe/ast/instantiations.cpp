@@ -0,0 +1,49 @@
+#include "instantiations.hpp"
+
+#include <mutex>
+
+
+using namespace cringe;
+using namespace cringe::AST;
+
+
+size_t InstantiationCache::KeyHash::operator () (const Key & key) const {
+    size_t result = key.size();
+
+    for (auto it : key) {
+        result ^= std::hash<const Node *>()(it) + 0x9E3779B9 + (result << 6) + (result >> 2);
+    }
+
+    return result;
+}
+
+
+DetailedNode<TypeNode> * InstantiationCache::get(const Key & key, const std::function<DetailedNode<TypeNode> *()> & create) {
+    {
+        std::shared_lock lock{protector};
+        auto found = instantiations.find(key);
+
+        if (found != instantiations.end()) {
+            return found->second;
+        }
+    }
+
+    std::unique_lock lock{protector};
+    auto found = instantiations.find(key);
+
+    // another thread may have
+    // been faster
+    if (found != instantiations.end()) {
+        return found->second;
+    }
+
+    auto result = create();
+    instantiations.emplace(key, result);
+    return result;
+}
+
+
+size_t InstantiationCache::get_size() const {
+    std::shared_lock lock{protector};
+    return instantiations.size();
+}
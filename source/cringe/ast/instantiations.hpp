@@ -0,0 +1,53 @@
+// Copyright (C) 2020 luna_koly
+//
+// Shared representations of the
+// instantiated types like `Map<Int, String>`.
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "visitor.hpp"
+
+
+namespace cringe {
+    namespace AST {
+        /**
+         * Maps the base declaration and the
+         * canonical argument types to the one
+         * TypeNode all the occurrences share.
+         * Safe to use from any thread.
+         */
+        class InstantiationCache {
+        public:
+            /**
+             * The base goes first,
+             * the arguments follow.
+             */
+            using Key = std::vector<const Node *>;
+
+            /**
+             * Returns the instantiation for the key,
+             * calling `create` only if there's none
+             * yet. Whatever it makes must outlive
+             * the cache.
+             */
+            DetailedNode<TypeNode> * get(const Key & key, const std::function<DetailedNode<TypeNode> *()> & create);
+
+            size_t get_size() const;
+
+        private:
+            struct KeyHash {
+                size_t operator () (const Key & key) const;
+            };
+
+            std::unordered_map<Key, DetailedNode<TypeNode> *, KeyHash> instantiations;
+            mutable std::shared_mutex protector;
+        };
+    }
+}
@@ -1,10 +1,65 @@
 #include "nodes.hpp"
 
+#include <atomic>
+
 
 using namespace cringe;
 using namespace cringe::AST;
 
 
+/**
+ * Threads take this many ids at once,
+ * so they rarely touch the counter.
+ */
+static const uint64_t IDS_BLOCK_SIZE = 1024;
+
+static std::atomic<uint64_t> next_ids_block = 0;
+
+static thread_local uint64_t next_id = 0;
+static thread_local uint64_t ids_block_end = 0;
+
+
+static uint64_t create_id() {
+    if (next_id == ids_block_end) {
+        next_id = next_ids_block.fetch_add(IDS_BLOCK_SIZE, std::memory_order_relaxed);
+        ids_block_end = next_id + IDS_BLOCK_SIZE;
+    }
+
+    return next_id++;
+}
+
+
+Node::Node() : id(create_id()) {
+    NodeRegion::adopt(this);
+}
+
+Node::Node(const Node & other) : id(create_id()) {
+    NodeRegion::adopt(this);
+}
+
+
+DetailedNode<IdentifierNode> * cringe::AST::extract_typealias_name(DetailedNode<TypealiasDeclarationNode> * node) {
+    auto type = extract<TypeNode>(node->details.type);
+
+    if (type == nullptr) {
+        // stand-ins are named directly
+        return extract<IdentifierNode>(node->details.type);
+    }
+
+    return extract<IdentifierNode>(type->details.identifier);
+}
+
+DetailedNode<NodeList> * cringe::AST::extract_type_parameters(DetailedNode<TypealiasDeclarationNode> * node) {
+    auto type = extract<TypeNode>(node->details.type);
+
+    if (type == nullptr || type->details.subtypes == nullptr || type->details.subtypes->details.values.empty()) {
+        return nullptr;
+    }
+
+    return type->details.subtypes;
+}
+
+
 #define __PRINT_NODE__(T) __IMPLEMENT_PRINT__(DetailedNode<T>)
 
 
@@ -126,7 +181,7 @@ __PRINT_NODE__(BinaryExpressionNode) {
         output << "<!MISSING EXPRESSION!><!>";
     }
 
-    output << ' ' << details.operator_token << ' ';
+    output << ' ' << details.operation << ' ';
 
     if (details.right != nullptr) {
         output << *details.right;
@@ -139,7 +194,7 @@ __PRINT_NODE__(BinaryExpressionNode) {
 
 
 __PRINT_NODE__(UnaryExpressionNode) {
-    output << '(' << details.operator_token;
+    output << '(' << details.operation;
 
     if (details.target != nullptr) {
         output << *details.target;
@@ -177,8 +232,8 @@ __PRINT_NODE__(IdentifierNode) {
 
 
 __PRINT_NODE__(NumberLiteralNode) {
-    if (std::holds_alternative<int>(details.calculated)) {
-        return output << std::get<int>(details.calculated);
+    if (std::holds_alternative<int64_t>(details.calculated)) {
+        return output << std::get<int64_t>(details.calculated);
     }
 
     return output << std::get<double>(details.calculated);
@@ -7,12 +7,17 @@
 
 #include "visitor.hpp"
 #include "scopes.hpp"
+#include "operators.hpp"
+#include "regions.hpp"
 
 #include <orders/util/printable.hpp>
+#include <orders/util/interner.hpp>
+#include <orders/parsing/diagnostics.hpp>
 
 #include <vector>
 #include <string>
 #include <variant>
+#include <cstdint>
 
 
 #define __EASILY_CONVERTIBLE__(T)           \
@@ -25,8 +30,23 @@ struct cringe::AST::Node : public orders::Printable {
     __WITH_ACCEPT__
     __WITH_PURE_PRINT__
 
+    /**
+     * Nodes belong to the current
+     * NodeRegion, if there's one.
+     */
+    Node();
+    Node(const Node & other);
+
     virtual ~Node() {}
 
+    /**
+     * Unique per node, copies get their
+     * own. Ids are given out in blocks
+     * per thread, so they're dense enough
+     * to index arrays with.
+     */
+    const uint64_t id;
+
     /**
      * Only the ErrorNode shows true here.
      */
@@ -82,6 +102,11 @@ struct cringe::AST::GlobalNode {
 
 struct cringe::AST::FileNode {
     std::string filename;
+    /**
+     * The id the file's text has
+     * in the session sources.
+     */
+    orders::FileId file = orders::NO_FILE;
     Node * root;
 };
 
@@ -96,6 +121,27 @@ struct cringe::AST::ConstantDeclarationNode {
 struct cringe::AST::TypealiasDeclarationNode {
     Node * type;
     Node * value;
+    /**
+     * Where the value is resolved,
+     * known once it's been found.
+     */
+    Scope * enclosing_scope = nullptr;
+    /**
+     * Declares the type parameters of
+     * a generic alias, the value is
+     * resolved here then.
+     */
+    Scope * scope = nullptr;
+    /**
+     * The type at the end of the chain
+     * of aliases, once collapsed.
+     */
+    DetailedNode<TypeNode> * target = nullptr;
+    /**
+     * Set while the chain is being
+     * followed, to notice cycles.
+     */
+    bool is_collapsing = false;
 };
 
 
@@ -109,18 +155,23 @@ struct cringe::AST::VariableDeclarationNode {
 struct cringe::AST::BinaryExpressionNode {
     Node * left;
     Node * right;
-    std::string operator_token;
+    Operator operation;
 };
 
 
 struct cringe::AST::UnaryExpressionNode {
     Node * target;
-    std::string operator_token;
+    Operator operation;
 };
 
 
 struct cringe::AST::QualifiedAccessNode {
     DetailedNode<NodeList> * identifiers;
+    /**
+     * Where the first identifier is
+     * declared, once resolved.
+     */
+    Binding binding;
 };
 
 
@@ -131,12 +182,21 @@ struct cringe::AST::CharacterLiteralNode {
 
 struct cringe::AST::IdentifierNode {
     std::string value;
+    /**
+     * The interned `value`, none for
+     * nodes made up by the resolvers.
+     */
+    orders::Symbol symbol;
+    /**
+     * Where it's declared, once resolved.
+     */
+    Binding binding;
 };
 
 
 struct cringe::AST::NumberLiteralNode {
     std::string value;
-    std::variant<int, double> calculated;
+    std::variant<int64_t, double> calculated;
 };
 
 
@@ -149,6 +209,12 @@ struct cringe::AST::TypeNode {
     Node * identifier;
     DetailedNode<NodeList> * subtypes;
     Node * declaration = nullptr;
+    /**
+     * Comes from the instantiations
+     * cache, so equal instantiations
+     * have equal addresses.
+     */
+    bool is_shared = false;
 };
 
 
@@ -174,3 +240,19 @@ struct cringe::AST::WhileStatementNode {
     Node * on_true;
     Scope * scope = nullptr;
 };
+
+
+namespace cringe {
+    namespace AST {
+        /**
+         * Alias names are parsed as types, returns
+         * the identifier without the parameters.
+         */
+        DetailedNode<IdentifierNode> * extract_typealias_name(DetailedNode<TypealiasDeclarationNode> * node);
+        /**
+         * The type parameters of a generic
+         * alias or nullptr if there're none.
+         */
+        DetailedNode<NodeList> * extract_type_parameters(DetailedNode<TypealiasDeclarationNode> * node);
+    }
+}
@@ -0,0 +1,157 @@
+#include "operators.hpp"
+
+#include <array>
+#include <iterator>
+#include <string_view>
+
+
+using namespace cringe::AST;
+
+
+struct OperatorDefinition {
+    std::string_view lexeme;
+    Operator kind;
+    /**
+     * 0 if it's not a binary
+     * operator in expressions.
+     */
+    int binary_precedence = 0;
+    bool is_right_associative = false;
+    bool is_prefix = false;
+};
+
+/**
+ * Ordered as the enum, so that the
+ * definition of `it` is OPERATORS[it - 1].
+ * Adding an operator to expressions is
+ * a matter of setting its precedence.
+ */
+static constexpr OperatorDefinition OPERATORS[] = {
+    {"+", Operator::PLUS, 1},
+    {"-", Operator::MINUS, 1, false, true},
+    {"*", Operator::MULTIPLY, 2},
+    {"/", Operator::DIVIDE, 2},
+    {"=", Operator::ASSIGN},
+    {"->", Operator::ARROW},
+    {",", Operator::COMMA},
+    {".", Operator::DOT},
+    {":", Operator::COLON},
+    {"(", Operator::LEFT_PARENTHESIS},
+    {")", Operator::RIGHT_PARENTHESIS},
+    {"<", Operator::LESS},
+    {">", Operator::GREATER},
+};
+
+static constexpr bool is_ordered_as_enum() {
+    for (size_t it = 0; it < std::size(OPERATORS); it++) {
+        if ((size_t) OPERATORS[it].kind != it + 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static_assert(is_ordered_as_enum(), "OPERATORS must follow the order of Operator");
+
+static const OperatorDefinition & get_definition(Operator it) {
+    static const OperatorDefinition none = {"", Operator::NONE};
+
+    if (it == Operator::NONE) {
+        return none;
+    }
+
+    return OPERATORS[(size_t) it - 1];
+}
+
+
+/**
+ * Built at compile time. Node 0 is the
+ * root, 0 in `next` means no edge.
+ */
+struct OperatorTrie {
+    /**
+     * Operators are ASCII.
+     */
+    static constexpr size_t ALPHABET_SIZE = 128;
+    static constexpr size_t MAX_NODES_COUNT = 32;
+
+    struct Node {
+        Operator terminal = Operator::NONE;
+        std::array<uint8_t, ALPHABET_SIZE> next = {};
+    };
+
+    std::array<Node, MAX_NODES_COUNT> nodes = {};
+    size_t nodes_count = 1;
+
+    constexpr OperatorTrie() {
+        for (auto & it : OPERATORS) {
+            size_t node = 0;
+
+            for (char character : it.lexeme) {
+                auto & next = nodes[node].next[(uint8_t) character];
+
+                if (next == 0) {
+                    next = (uint8_t) nodes_count++;
+                }
+
+                node = next;
+            }
+
+            nodes[node].terminal = it.kind;
+        }
+    }
+};
+
+static constexpr OperatorTrie TRIE{};
+
+static_assert(TRIE.nodes_count <= OperatorTrie::MAX_NODES_COUNT, "Increase MAX_NODES_COUNT");
+
+
+OperatorMatch cringe::AST::match_operator(const char * begin, const char * end) {
+    OperatorMatch result;
+    size_t node = 0;
+
+    for (auto it = begin; it != end; it++) {
+        auto character = (uint8_t) *it;
+
+        if (character >= OperatorTrie::ALPHABET_SIZE) {
+            break;
+        }
+
+        node = TRIE.nodes[node].next[character];
+
+        if (node == 0) {
+            break;
+        }
+
+        if (TRIE.nodes[node].terminal != Operator::NONE) {
+            result.kind = TRIE.nodes[node].terminal;
+            result.length = (it - begin) + 1;
+        }
+    }
+
+    return result;
+}
+
+
+const char * cringe::AST::get_lexeme(Operator it) {
+    return get_definition(it).lexeme.data();
+}
+
+int cringe::AST::get_binary_precedence(Operator it) {
+    return get_definition(it).binary_precedence;
+}
+
+bool cringe::AST::is_right_associative(Operator it) {
+    return get_definition(it).is_right_associative;
+}
+
+bool cringe::AST::is_prefix(Operator it) {
+    return get_definition(it).is_prefix;
+}
+
+
+std::ostream & operator << (std::ostream & output, cringe::AST::Operator self) {
+    return output << get_lexeme(self);
+}
@@ -0,0 +1,67 @@
+// Copyright (C) 2020 luna_koly
+//
+// All the operators of the language
+// and the way to recognize them.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+
+namespace cringe {
+    namespace AST {
+        /**
+         * Fits into a byte, so expression
+         * nodes don't own strings.
+         */
+        enum class Operator : uint8_t {
+            NONE,
+            PLUS, MINUS, MULTIPLY, DIVIDE,
+            ASSIGN, ARROW, COMMA, DOT, COLON,
+            LEFT_PARENTHESIS, RIGHT_PARENTHESIS,
+            LESS, GREATER
+        };
+
+        /**
+         * The text of the operator.
+         */
+        const char * get_lexeme(Operator it);
+
+        /**
+         * How tightly a binary operator binds
+         * its operands in expressions. 0 means
+         * it's not a binary one.
+         */
+        int get_binary_precedence(Operator it);
+
+        /**
+         * `a @ b @ c` is `a @ (b @ c)`.
+         */
+        bool is_right_associative(Operator it);
+
+        /**
+         * May go before an operand.
+         */
+        bool is_prefix(Operator it);
+
+        /**
+         * What `match_operator` has found.
+         */
+        struct OperatorMatch {
+            Operator kind = Operator::NONE;
+            size_t length = 0;
+        };
+
+        /**
+         * Finds the longest operator the text
+         * starts with in a single pass.
+         */
+        OperatorMatch match_operator(const char * begin, const char * end);
+    }
+}
+
+
+std::ostream & operator << (std::ostream & output, cringe::AST::Operator self);
@@ -0,0 +1,53 @@
+#include "regions.hpp"
+
+#include "nodes.hpp"
+#include "scopes.hpp"
+
+
+using namespace cringe;
+using namespace cringe::AST;
+
+
+/**
+ * Regions are per thread, so nodes
+ * never need any locking to be adopted.
+ */
+static thread_local NodeRegion * current_region = nullptr;
+
+
+NodeRegion::~NodeRegion() {
+    for (auto it : nodes) {
+        delete it;
+    }
+
+    for (auto it : scopes) {
+        delete it;
+    }
+}
+
+
+NodeRegion::Entered::Entered(NodeRegion * region) : previous(current_region) {
+    current_region = region;
+}
+
+NodeRegion::Entered::~Entered() {
+    current_region = previous;
+}
+
+
+size_t NodeRegion::get_nodes_count() const {
+    return nodes.size();
+}
+
+
+void NodeRegion::adopt(Node * node) {
+    if (current_region != nullptr) {
+        current_region->nodes.push_back(node);
+    }
+}
+
+void NodeRegion::adopt(Scope * scope) {
+    if (current_region != nullptr) {
+        current_region->scopes.push_back(scope);
+    }
+}
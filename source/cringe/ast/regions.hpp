@@ -0,0 +1,66 @@
+// Copyright (C) 2020 luna_koly
+//
+// Lets a bunch of nodes be freed at once,
+// so a file's tree doesn't have to live
+// until the very end of the compilation.
+// The texts the trees are parsed from stay
+// in the SourceManager anyway: streaming
+// parses them again and diagnostics show
+// them when printed.
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "visitor.hpp"
+
+
+namespace cringe {
+    namespace AST {
+        struct Scope;
+
+        /**
+         * Owns every node and scope created on
+         * a thread while the region is entered
+         * there, and deletes them all together.
+         * Nothing outside may keep pointers to
+         * them by then.
+         */
+        class NodeRegion {
+        public:
+            NodeRegion() = default;
+            NodeRegion(const NodeRegion &) = delete;
+            NodeRegion & operator = (const NodeRegion &) = delete;
+
+            ~NodeRegion();
+
+            /**
+             * Makes the region the current one
+             * of the calling thread until the
+             * guard is gone.
+             */
+            struct Entered {
+                Entered(NodeRegion * region);
+                ~Entered();
+
+                NodeRegion * previous;
+            };
+
+            size_t get_nodes_count() const;
+
+            /**
+             * Called by the constructors, does
+             * nothing if no region is entered.
+             */
+            static void adopt(Node * node);
+
+            static void adopt(Scope * scope);
+
+        private:
+            std::vector<Node *> nodes;
+            std::vector<Scope *> scopes;
+        };
+    }
+}
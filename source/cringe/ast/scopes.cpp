@@ -6,59 +6,114 @@ using namespace cringe;
 using namespace cringe::AST;
 
 
-Scope::Scope(Scope * parent) : parent(parent) {}
+Scope::Scope(Scope * parent) : parent(parent) {
+    NodeRegion::adopt(this);
+}
+
+/**
+ * Builtin types are named
+ * by interned identifiers.
+ */
+static Node * create_builtin(Session & session, const std::string & name) {
+    return new DetailedNode{TypeNode{
+        .identifier = new DetailedNode{IdentifierNode{
+            .value = name,
+            .symbol = session.interner.intern(name)
+        }},
+        .subtypes = new DetailedNode{NodeList()}
+    }};
+}
 
-Scope * Scope::create_global() {
+Scope * Scope::create_global(Session & session) {
     auto global = new Scope();
 
-    global->add("Int", new DetailedNode{TypeNode{
-        .identifier = new DetailedNode{IdentifierNode{"Int"}},
-        .subtypes = new DetailedNode{NodeList()}
-    }});
+    for (auto name : {"Int", "Real", "Char", "String"}) {
+        global->add(session.interner.intern(name), create_builtin(session, name));
+    }
 
-    global->add("Real", new DetailedNode{TypeNode{
-        .identifier = new DetailedNode{IdentifierNode{"Real"}},
-        .subtypes = new DetailedNode{NodeList()}
-    }});
+    return global;
+}
 
-    global->add("Char", new DetailedNode{TypeNode{
-        .identifier = new DetailedNode{IdentifierNode{"Char"}},
-        .subtypes = new DetailedNode{NodeList()}
-    }});
 
-    global->add("String", new DetailedNode{TypeNode{
-        .identifier = new DetailedNode{IdentifierNode{"String"}},
-        .subtypes = new DetailedNode{NodeList()}
-    }});
+uint64_t Scope::get_filter_bits(orders::Symbol name) {
+    // symbol ids are sequential, spread
+    // them before taking the bits
+    auto hash = (uint64_t) name.id * 0x9E3779B97F4A7C15;
+    return (1ull << (hash >> 58)) | (1ull << ((hash >> 52) & 63));
+}
 
-    return global;
+bool Scope::may_contain(orders::Symbol name) const {
+    auto bits = get_filter_bits(name);
+    return (filter.load(std::memory_order_acquire) & bits) == bits;
 }
 
 
-void Scope::add(const std::string & name, AST::Node * declaration) {
-    declarations[name] = declaration;
+void Scope::add(orders::Symbol name, AST::Node * declaration) {
+    auto found = indices.find(name);
+
+    if (found == indices.end()) {
+        filter.fetch_or(get_filter_bits(name), std::memory_order_release);
+        indices.emplace(name, (uint32_t) slots.size());
+        slots.emplace_back(name, declaration);
+        version.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    auto & slot = slots[found->second].second;
+
+    // resolvers register the same
+    // declarations more than once
+    if (slot != declaration) {
+        slot = declaration;
+        version.fetch_add(1, std::memory_order_release);
+    }
+}
+
+
+/**
+ * Identifiers made up by the resolvers
+ * carry no symbol, but if their name has
+ * never been interned, nothing can be
+ * declared under it anyway.
+ */
+static orders::Symbol get_symbol(Session & session, DetailedNode<IdentifierNode> * node) {
+    if (node->details.symbol.is_none()) {
+        return session.interner.find(node->details.value);
+    }
+
+    return node->details.symbol;
 }
 
 
 struct ScopeExtractor : public Visitor {
     Scope * result = nullptr;
+    /**
+     * The node may have a scope, but
+     * declares nothing in it.
+     */
+    bool is_empty_owner = false;
+
+    void use(Scope * scope) {
+        result = scope;
+        is_empty_owner = scope == nullptr;
+    }
 
     virtual void visit(Node * it) override {}
 
     virtual void visit(DetailedNode<GlobalNode> * it) override {
-        result = it->details.scope;
+        use(it->details.scope);
     }
 
     virtual void visit(DetailedNode<FunctionStatementNode> * it) override {
-        result = it->details.scope;
+        use(it->details.scope);
     }
 
     virtual void visit(DetailedNode<IfStatementNode> * it) override {
-        result = it->details.scope;
+        use(it->details.scope);
     }
 
     virtual void visit(DetailedNode<WhileStatementNode> * it) override {
-        result = it->details.scope;
+        use(it->details.scope);
     }
 };
 
@@ -79,57 +134,232 @@ Node * Scope::resolve(Session & session, Node * node) {
     return nullptr;
 }
 
-Node * Scope::resolve(Session & session, DetailedNode<QualifiedAccessNode> * qualified_access) {
-    auto names = qualified_access->details.identifiers->details.values;
-    Node * declaration = nullptr;
-    Scope * scope = this;
+size_t Scope::PathHash::operator () (const std::vector<orders::Symbol> & path) const {
+    size_t result = path.size();
+
+    for (auto it : path) {
+        result ^= std::hash<orders::Symbol>()(it) + 0x9E3779B9 + (result << 6) + (result >> 2);
+    }
 
-    for (size_t it = 0; it < names.size(); it++) {
-        auto name = extract<IdentifierNode>(names[it]);
+    return result;
+}
 
-        if (name == nullptr) {
-            // session.reporter <<
-            return nullptr;
+Scope::CachedPath Scope::walk(const std::vector<orders::Symbol> & path) const {
+    CachedPath entry{
+        .state = CachedPath::State::FOUND,
+        .version = version.load(std::memory_order_acquire)
+    };
+
+    const Scope * scope = this;
+    bool is_empty_owner = false;
+
+    for (size_t it = 0; it < path.size(); it++) {
+        // an empty block has no scope of its own,
+        // but it's still a miss rather than
+        // something without members at all
+        if (scope == nullptr && is_empty_owner) {
+            entry.state = CachedPath::State::MISSING;
+            entry.declaration = nullptr;
+            entry.path_slots.clear();
+            return entry;
         }
 
         if (scope == nullptr) {
-            // session.reporter <<
-            return nullptr;
+            entry.state = CachedPath::State::FAILED;
+            entry.declaration = nullptr;
+            entry.path_slots.clear();
+            return entry;
+        }
+
+        if (scope != this) {
+            entry.members.emplace_back(scope, scope->version.load(std::memory_order_acquire));
+        }
+
+        auto that = scope->indices.end();
+
+        if (scope->may_contain(path[it])) {
+            that = scope->indices.find(path[it]);
+        }
+
+        if (that == scope->indices.end()) {
+            entry.state = CachedPath::State::MISSING;
+            entry.declaration = nullptr;
+            entry.path_slots.clear();
+            return entry;
         }
 
-        auto that = scope->declarations.find(name->details.value);
+        entry.path_slots.push_back(that->second);
+        entry.declaration = scope->slots[that->second].second;
+
+        ScopeExtractor extractor;
+        entry.declaration->accept(&extractor);
+        scope = extractor.result;
+        is_empty_owner = extractor.is_empty_owner;
+    }
+
+    return entry;
+}
+
+bool Scope::is_valid(const CachedPath & entry) const {
+    if (entry.version != version.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    for (auto & it : entry.members) {
+        if (it.second != it.first->version.load(std::memory_order_acquire)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Scope::CachedPath::State Scope::lookup(const std::vector<orders::Symbol> & path, Node *& declaration, std::vector<uint32_t> * path_slots) {
+    {
+        std::shared_lock lock(paths_protector);
+        auto found = paths.find(path);
+
+        if (found != paths.end() && is_valid(found->second)) {
+            declaration = found->second.declaration;
+
+            if (path_slots != nullptr) {
+                *path_slots = found->second.path_slots;
+            }
 
-        if (that != scope->declarations.end()) {
-            declaration = that->second;
-            scope = extract_scope(declaration);
-        } else {
-            declaration = nullptr;
-            break;
+            return found->second.state;
         }
     }
 
-    if (declaration == nullptr && parent != nullptr) {
-        return parent->resolve(session, qualified_access);
+    auto entry = walk(path);
+    auto state = entry.state;
+    declaration = entry.declaration;
+
+    if (path_slots != nullptr) {
+        *path_slots = entry.path_slots;
     }
 
-    return declaration;
+    std::unique_lock lock(paths_protector);
+    paths.insert_or_assign(path, std::move(entry));
+    return state;
 }
 
-AST::Node * Scope::resolve(Session & session, AST::DetailedNode<AST::IdentifierNode> * node) {
-    auto that = declarations.find(node->details.value);
+Node * Scope::find(Session & session, DetailedNode<QualifiedAccessNode> * qualified_access, bool should_bind) {
+    auto & names = qualified_access->details.identifiers->details.values;
+    std::vector<orders::Symbol> path;
+    path.reserve(names.size());
+
+    // nothing is ever declared under the
+    // none symbol, so a non-identifier
+    // part makes the path unresolvable
+    for (auto it : names) {
+        auto name = extract<IdentifierNode>(it);
+        path.push_back(name != nullptr ? get_symbol(session, name) : orders::Symbol());
+    }
+
+    std::vector<uint32_t> path_slots;
+    uint32_t depth = 0;
+
+    for (auto scope = this; scope != nullptr; scope = scope->parent, depth++) {
+        // most levels don't declare the first
+        // part, skip them without locking
+        if (!path.empty() && !scope->may_contain(path.front())) {
+            continue;
+        }
+
+        Node * declaration = nullptr;
+        auto state = scope->lookup(path, declaration, should_bind ? &path_slots : nullptr);
+
+        if (state == CachedPath::State::MISSING) {
+            continue;
+        }
+
+        if (should_bind) {
+            auto binding = Binding();
 
-    if (that != declarations.end()) {
-        return that->second;
+            // the first part is looked up the usual
+            // way, the rest inside the previous one
+            for (size_t it = 0; it < path_slots.size(); it++) {
+                auto name = extract<IdentifierNode>(names[it]);
+                name->details.binding = Binding{it == 0 ? depth : 0, path_slots[it]};
+            }
+
+            if (!path_slots.empty()) {
+                binding = Binding{depth, path_slots.front()};
+            }
+
+            qualified_access->details.binding = binding;
+        }
+
+        return declaration;
+    }
+
+    if (should_bind) {
+        qualified_access->details.binding = Binding();
     }
 
-    if (parent != nullptr) {
-        return parent->resolve(session, node);
+    return nullptr;
+}
+
+Node * Scope::find(orders::Symbol name, Binding & binding) const {
+    uint32_t depth = 0;
+
+    for (auto scope = this; scope != nullptr; scope = scope->parent, depth++) {
+        if (!scope->may_contain(name)) {
+            continue;
+        }
+
+        auto found = scope->indices.find(name);
+
+        if (found != scope->indices.end()) {
+            binding = Binding{depth, found->second};
+            return scope->slots[found->second].second;
+        }
     }
 
+    binding = Binding();
     return nullptr;
 }
 
+Node * Scope::resolve(Session & session, DetailedNode<QualifiedAccessNode> * qualified_access) {
+    return find(session, qualified_access, false);
+}
+
+Node * Scope::bind(Session & session, DetailedNode<QualifiedAccessNode> * qualified_access) {
+    return find(session, qualified_access, true);
+}
+
+Node * Scope::resolve(Session & session, DetailedNode<IdentifierNode> * node) {
+    Binding binding;
+    return find(get_symbol(session, node), binding);
+}
+
+Node * Scope::bind(Session & session, DetailedNode<IdentifierNode> * node) {
+    return find(get_symbol(session, node), node->details.binding);
+}
+
+Node * Scope::get(Binding binding) const {
+    if (binding.is_none()) {
+        return nullptr;
+    }
+
+    auto scope = this;
+
+    for (uint32_t it = 0; it < binding.depth && scope != nullptr; it++) {
+        scope = scope->parent;
+    }
+
+    if (scope == nullptr || binding.slot >= scope->slots.size()) {
+        return nullptr;
+    }
+
+    return scope->slots[binding.slot].second;
+}
+
+Scope * Scope::get_parent() const {
+    return parent;
+}
+
 
-const std::map<std::string, AST::Node *> & Scope::get_declarations() const {
-    return declarations;
+const std::vector<std::pair<orders::Symbol, AST::Node *>> & Scope::get_declarations() const {
+    return slots;
 }
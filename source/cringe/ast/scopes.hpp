@@ -5,8 +5,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
-#include <map>
+#include <vector>
+#include <shared_mutex>
+#include <unordered_map>
 
 #include "visitor.hpp"
 #include "../session.hpp"
@@ -14,6 +17,22 @@
 
 namespace cringe {
     namespace AST {
+        /**
+         * Where a name's declaration lives: `depth`
+         * scopes up from the one it's used in, at
+         * the `slot`-th place there.
+         */
+        struct Binding {
+            static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+            uint32_t depth = NONE;
+            uint32_t slot = 0;
+
+            bool is_none() const {
+                return depth == NONE;
+            }
+        };
+
         /**
          * Resolves types.
          */
@@ -25,12 +44,12 @@ namespace cringe {
              * Creates a new scope and sets up
              * the builtins.
              */
-            static Scope * create_global();
+            static Scope * create_global(Session & session);
 
             /**
              * Registers a new local declaration.
              */
-            void add(const std::string & name, AST::Node * declaration);
+            void add(orders::Symbol name, AST::Node * declaration);
 
             /**
              * Returns the declaration that matches
@@ -51,9 +70,34 @@ namespace cringe {
             AST::Node * resolve(Session & session, AST::Node * node);
 
             /**
-             * Allows to access the inner mapping.
+             * Same as `resolve()`, but also writes
+             * the coordinates of the declaration
+             * into the node.
              */
-            const std::map<std::string, AST::Node *> & get_declarations() const;
+            AST::Node * bind(Session & session, AST::DetailedNode<AST::IdentifierNode> * node);
+
+            /**
+             * Same as `resolve()`, but also writes
+             * the coordinates of the first part into
+             * the node and into its first identifier.
+             * Others get their slots within the
+             * scopes of the preceding parts.
+             */
+            AST::Node * bind(Session & session, AST::DetailedNode<AST::QualifiedAccessNode> * qualified_access);
+
+            /**
+             * The declaration at the coordinates
+             * relative to this scope, no lookups.
+             */
+            AST::Node * get(Binding binding) const;
+
+            Scope * get_parent() const;
+
+            /**
+             * The declarations in the order of
+             * their slots.
+             */
+            const std::vector<std::pair<orders::Symbol, AST::Node *>> & get_declarations() const;
 
         private:
             /**
@@ -63,9 +107,104 @@ namespace cringe {
             Scope * parent;
 
             /**
-             * Just stores the mapping.
+             * A name keeps its slot when
+             * it's declared again.
+             */
+            std::vector<std::pair<orders::Symbol, AST::Node *>> slots;
+
+            /**
+             * Maps names to their slots.
+             */
+            std::unordered_map<orders::Symbol, uint32_t> indices;
+
+            /**
+             * Two bits per declared name. If any
+             * of a name's bits is unset, the name
+             * is certainly not declared here.
+             */
+            std::atomic<uint64_t> filter = 0;
+
+            /**
+             * Grows whenever `slots` change,
+             * so that cached paths may
+             * notice it.
+             */
+            std::atomic<uint32_t> version = 0;
+
+            /**
+             * What a qualified path means
+             * within this very scope.
+             */
+            struct CachedPath {
+                enum class State : uint8_t {
+                    FOUND,
+                    /**
+                     * Not here, ask the parent.
+                     */
+                    MISSING,
+                    /**
+                     * Some prefix has no members,
+                     * the parents aren't asked.
+                     */
+                    FAILED
+                };
+
+                State state;
+                AST::Node * declaration = nullptr;
+                uint32_t version;
+                /**
+                 * Slot of each part within
+                 * its scope, if found.
+                 */
+                std::vector<uint32_t> path_slots;
+                /**
+                 * Scopes of the prefixes and their
+                 * versions at the time of the walk.
+                 */
+                std::vector<std::pair<const Scope *, uint32_t>> members;
+            };
+
+            struct PathHash {
+                size_t operator () (const std::vector<orders::Symbol> & path) const;
+            };
+
+            /**
+             * Both hits and misses are kept, a miss
+             * is what makes the parents' lookups
+             * cheap for deeply nested code.
+             */
+            std::unordered_map<std::vector<orders::Symbol>, CachedPath, PathHash> paths;
+            mutable std::shared_mutex paths_protector;
+
+            /**
+             * Walks the path from here, no cache.
+             */
+            CachedPath walk(const std::vector<orders::Symbol> & path) const;
+
+            /**
+             * Same as `walk()`, but cached.
+             */
+            CachedPath::State lookup(const std::vector<orders::Symbol> & path, AST::Node *& declaration, std::vector<uint32_t> * path_slots);
+
+            bool is_valid(const CachedPath & entry) const;
+
+            static uint64_t get_filter_bits(orders::Symbol name);
+
+            /**
+             * False means no, true means maybe.
+             */
+            bool may_contain(orders::Symbol name) const;
+
+            /**
+             * Resolves and optionally binds.
+             */
+            AST::Node * find(Session & session, AST::DetailedNode<AST::QualifiedAccessNode> * qualified_access, bool should_bind);
+
+            /**
+             * Walks the parents looking
+             * for the name.
              */
-            std::map<std::string, AST::Node *> declarations;
+            AST::Node * find(orders::Symbol name, Binding & binding) const;
         };
 
         /**
@@ -0,0 +1,102 @@
+#include "type_table.hpp"
+
+#include <iostream>
+#include <exception>
+
+
+using namespace cringe;
+using namespace cringe::AST;
+
+
+TypeTable::TypeTable() : directories(DIRECTORIES_COUNT) {}
+
+TypeTable::~TypeTable() {
+    for (auto & it : directories) {
+        auto directory = it.load(std::memory_order_relaxed);
+
+        if (directory == nullptr) {
+            continue;
+        }
+
+        for (auto & chunk : directory->chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        delete directory;
+    }
+}
+
+
+/**
+ * Returns what the slot points to, filling
+ * it with `create()` first if it's empty.
+ * Whoever loses the race frees its copy.
+ */
+template <typename T, typename Create, typename Destroy>
+static T * get_or_create(std::atomic<T *> & slot, Create create, Destroy destroy) {
+    auto it = slot.load(std::memory_order_acquire);
+
+    if (it != nullptr) {
+        return it;
+    }
+
+    auto created = create();
+
+    if (slot.compare_exchange_strong(it, created, std::memory_order_acq_rel)) {
+        return created;
+    }
+
+    destroy(created);
+    return it;
+}
+
+
+void TypeTable::set(Node * node, DetailedNode<TypeNode> * type) {
+    auto chunk_index = node->id / CHUNK_SIZE;
+    auto directory_index = chunk_index / DIRECTORY_SIZE;
+
+    // that many nodes can't fit into memory,
+    // ids must have been wasted somewhere
+    if (directory_index >= DIRECTORIES_COUNT) {
+        std::cerr << "!!TypeTable has run out of node ids at `" << node->id << "`!!" << std::endl;
+        std::terminate();
+    }
+
+    auto directory = get_or_create(
+        directories[directory_index],
+        []() { return new Directory(); },
+        [](Directory * it) { delete it; }
+    );
+
+    auto chunk = get_or_create(
+        directory->chunks[chunk_index % DIRECTORY_SIZE],
+        []() { return new Chunk[CHUNK_SIZE](); },
+        [](Chunk * it) { delete[] it; }
+    );
+
+    chunk[node->id % CHUNK_SIZE] = type;
+}
+
+
+DetailedNode<TypeNode> * TypeTable::get(Node * node) const {
+    auto chunk_index = node->id / CHUNK_SIZE;
+    auto directory_index = chunk_index / DIRECTORY_SIZE;
+
+    if (directory_index >= DIRECTORIES_COUNT) {
+        return nullptr;
+    }
+
+    auto directory = directories[directory_index].load(std::memory_order_acquire);
+
+    if (directory == nullptr) {
+        return nullptr;
+    }
+
+    auto chunk = directory->chunks[chunk_index % DIRECTORY_SIZE].load(std::memory_order_acquire);
+
+    if (chunk == nullptr) {
+        return nullptr;
+    }
+
+    return chunk[node->id % CHUNK_SIZE];
+}
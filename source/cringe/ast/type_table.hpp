@@ -0,0 +1,65 @@
+// Copyright (C) 2020 luna_koly
+//
+// Types the resolvers have found
+// for the nodes, kept for later.
+
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "nodes.hpp"
+
+
+namespace cringe {
+    namespace AST {
+        /**
+         * Maps node ids to their types. Storage
+         * is a dense array split into chunks that
+         * appear on the first write, so threads
+         * may fill it at once as long as each
+         * writes its own nodes.
+         */
+        class TypeTable {
+        public:
+            TypeTable();
+            TypeTable(const TypeTable &) = delete;
+            TypeTable & operator = (const TypeTable &) = delete;
+
+            ~TypeTable();
+
+            /**
+             * Terminates if the id is beyond
+             * what the table may ever hold.
+             */
+            void set(Node * node, DetailedNode<TypeNode> * type);
+
+            /**
+             * nullptr if the node has never
+             * been given a type.
+             */
+            DetailedNode<TypeNode> * get(Node * node) const;
+
+        private:
+            static constexpr uint64_t CHUNK_SIZE = 1 << 14;
+            static constexpr uint64_t DIRECTORY_SIZE = 1 << 13;
+            static constexpr uint64_t DIRECTORIES_COUNT = 1 << 13;
+
+            using Chunk = DetailedNode<TypeNode> *;
+
+            /**
+             * Chunks are found through directories,
+             * so only the touched ranges of ids
+             * take any memory.
+             */
+            struct Directory {
+                std::atomic<Chunk *> chunks[DIRECTORY_SIZE] = {};
+            };
+
+            std::vector<std::atomic<Directory *>> directories;
+        };
+    }
+}
@@ -39,6 +39,7 @@ __PRINT_DIAGNOSTIC__(SingleQuoteExpectedDiagnostic) {
 __PRINT_DIAGNOSTIC__(AnotherTokenTypeExpectedDiagnostic) {
     using Hint = AnotherTokenTypeExpectedDiagnostic::Hint;
 
+    // the hint replaces the usual header
     switch (details.hint) {
         case Hint::VARIABLE_DECLARATION:
             output << "Error in the variable declaration > ";
@@ -60,7 +61,7 @@ __PRINT_DIAGNOSTIC__(AnotherTokenTypeExpectedDiagnostic) {
             break;
     }
 
-    return __DIAGNOSTIC_HEADER__
+    return output
         << "`" << details.expected << "` expected, but `" << details.token << "` found.";
 }
 
@@ -68,6 +69,8 @@ __PRINT_DIAGNOSTIC__(AnotherTokenTypeExpectedDiagnostic) {
 __PRINT_DIAGNOSTIC__(OperatorExpectedDiagnostic) {
     using Hint = OperatorExpectedDiagnostic::Hint;
 
+    __DIAGNOSTIC_HEADER__;
+
     switch (details.hint) {
         case Hint::NESTED_EXPRESSION:
             output << "Unclosed parentheses in the nested expression";
@@ -89,8 +92,8 @@ __PRINT_DIAGNOSTIC__(OperatorExpectedDiagnostic) {
             break;
     }
 
-    return __DIAGNOSTIC_HEADER__
-        << "`" << details.operator_token << "` expected.";
+    return output
+        << " > `" << details.operator_token << "` expected.";
 }
 
 
@@ -100,6 +103,13 @@ __PRINT_DIAGNOSTIC__(ExpressionExpectedDiagnostic) {
 }
 
 
+__PRINT_DIAGNOSTIC__(NumberOverflowDiagnostic) {
+    return __DIAGNOSTIC_HEADER__
+        << "The number `" << details.found << "` is too big for "
+        << (details.is_real ? "`Real`." : "`Int`, it must fit into 64 bits.");
+}
+
+
 __PRINT_DIAGNOSTIC__(TypeRedeclarationDiagnostic) {
     return __DIAGNOSTIC_HEADER__
         << "Type `" << details.name << "` has already been declared.";
@@ -112,6 +122,25 @@ __PRINT_DIAGNOSTIC__(InaccessibleTypeInformationDiagnostic) {
 }
 
 
+__PRINT_DIAGNOSTIC__(TypeArgumentsCountDiagnostic) {
+    __DIAGNOSTIC_HEADER__ << "Type `" << details.name << "` ";
+
+    if (details.expected == 0) {
+        output << "takes no type arguments";
+    } else {
+        output << "takes " << details.expected << (details.expected == 1 ? " type argument" : " type arguments");
+    }
+
+    return output << ", but " << details.found << " given.";
+}
+
+
+__PRINT_DIAGNOSTIC__(TypealiasCycleDiagnostic) {
+    return __DIAGNOSTIC_HEADER__
+        << "Type alias `" << details.name << "` refers to itself.";
+}
+
+
 __PRINT_DIAGNOSTIC__(UnresolvedReferenceDiagnostic) {
     return __DIAGNOSTIC_HEADER__
         << "Unresolved reference `" << details.accessor << "`.";
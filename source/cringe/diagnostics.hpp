@@ -146,6 +146,24 @@ namespace cringe {
         std::string found;
     };
 
+    /**
+     * A number literal too big
+     * to be represented.
+     */
+    struct NumberOverflowDiagnostic {
+        __DIAGNOSTIC__
+
+        /**
+         * The literal the
+         * user entered.
+         */
+        std::string found;
+        /**
+         * Whether it's `Real` or `Int`.
+         */
+        bool is_real;
+    };
+
     /**
      * User attempts to redeclare a type.
      */
@@ -172,6 +190,39 @@ namespace cringe {
         std::string accessor;
     };
 
+    /**
+     * `Int<String>` and the like.
+     */
+    struct TypeArgumentsCountDiagnostic {
+        __DIAGNOSTIC__
+
+        /**
+         * The type given
+         * the arguments.
+         */
+        std::string name;
+        /**
+         * The number of its
+         * type parameters.
+         */
+        size_t expected;
+        size_t found;
+    };
+
+    /**
+     * Type aliases that end up
+     * referring to themselves.
+     */
+    struct TypealiasCycleDiagnostic {
+        __DIAGNOSTIC__
+
+        /**
+         * The alias the cycle
+         * was noticed at.
+         */
+        std::string name;
+    };
+
     /**
      * Attempt to access an undeclared
      * identifier.
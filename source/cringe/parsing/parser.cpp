@@ -2,14 +2,17 @@
 
 #include "../diagnostics.hpp"
 #include "../ast/probably.hpp"
+#include "../ast/operators.hpp"
 
+#include <cstring>
 #include <fstream>
-#include <mutex>
+#include <sstream>
 
-#include <orders/streams/implementations/std_stream.hpp>
-#include <orders/streams/implementations/analyzable_stream.hpp>
+#include <orders/parsing/numbers.hpp>
+#include <orders/parsing/scanners.hpp>
+#include <orders/streams/implementations/source_stream.hpp>
 
-#include <threading/thread_pool.hpp>
+#include <threading/parallel.hpp>
 
 
 using namespace cringe;
@@ -63,21 +66,26 @@ struct ParsingContextBackend {
      */
     Session & session;
 
+    /**
+     * Where the errors go, usually
+     * the session one.
+     */
+    orders::DiagnosticReporter & reporter;
+
     /**
      * Full path to the input file.
      */
     std::string filename;
 
     /**
-     * A single file input.
+     * The id diagnostics refer to.
      */
-    orders::AnalyzableStream & input;
+    orders::FileId file;
 
     /**
-     * The line the token has
-     * been met at.
+     * A single file input.
      */
-    size_t line_number = 0;
+    orders::SourceStream & input;
 
     /**
     * The current indent `depth`.
@@ -132,53 +140,24 @@ struct ParsingContextBackend {
             next == '_';
     }
 
-    static bool is_binary_digit(char next) {
-        return next >= '0' && next <= '1';
-    }
-
-    static bool is_octal_digit(char next) {
-        return next >= '0' && next <= '7';
-    }
-
     static bool is_decimal_digit(char next) {
         return next >= '0' && next <= '9';
     }
 
-    static bool is_hexadecimal_uppercase_digit(char next) {
-        return next >= 'A' && next <= 'F';
-    }
-
-    static bool is_hexadecimal_lowercase_digit(char next) {
-        return next >= 'a' && next <= 'f';
-    }
-
 
     void read_space() {
-        while (
-            input.has_next() &&
-            is_space(input.peek())
-        ) {
-            input.step();
-        }
+        input.step(orders::scan_spaces(input.get_current(), input.get_end()));
     }
 
     int read_space_and_count() {
-        int count = 0;
-
-        while (
-            input.has_next() &&
-            is_space(input.peek())
-        ) {
-            if (input.peek() == ' ') {
-                count++;
-            } else if (input.peek() == '\t') {
-                count += session.options.tab_size;
-            }
+        auto start = input.get_current();
+        auto length = orders::scan_spaces(start, input.get_end());
+        auto spaces = orders::count_character(start, start + length, ' ');
+        auto tabs = orders::count_character(start, start + length, '\t');
 
-            input.step();
-        }
+        input.step(length);
 
-        return count;
+        return (int) (spaces + tabs * session.options.tab_size);
     }
 
     void prepare() {
@@ -189,7 +168,6 @@ struct ParsingContextBackend {
 
         while (input.peek() == '\n') {
             input.step();
-            line_number++;
             newline_found = true;
             new_level = read_space_and_count();
         }
@@ -210,10 +188,6 @@ struct ParsingContextBackend {
     }
 
     char read_character_representation() {
-        if (input.peek() == '\n') {
-            line_number += 1;
-        }
-
         if (input.peek() == '\\') {
             input.step();
 
@@ -228,68 +202,14 @@ struct ParsingContextBackend {
     }
 
 
-    std::string visualize() {
-        std::stringstream result;
-        std::stringstream highlight;
-        auto contents = input.get_text();
-
-        result << ' ' << line_number << " | ...";
-        highlight << std::string(result.str().length(), ' ');
-
-        for (size_t it = 0; it < input.buffer_indent; it++) {
-            if (contents[it] == '\n') {
-                result    << "<newline>";
-                highlight << "         ";
-            } else {
-                result << contents[it];
-                highlight << '~';
-            }
-        }
-
-        result << contents[input.buffer_indent];
-        highlight << '^';
-
-        for (size_t it = input.buffer_indent + 1; it < input.buffer_size; it++) {
-            if (contents[it] == '\n') {
-                result    << "<newline>";
-                highlight << "         ";
-            } else {
-                result << contents[it];
-                highlight << '~';
-            }
-        }
-
-        // just because I trim whitespaces
-        // at the end of a string in my text editor
-        // and I use this buffer visualization
-        // to compare tests.
-        auto highlight_result = highlight.str();
-        size_t trim_index = highlight_result.size() - 1;
-
-        while (
-            trim_index >= 0 &&
-            highlight_result[trim_index] == ' '
-        ) {
-            trim_index--;
-        }
-
-        result << "...\n" << highlight_result.substr(0, trim_index + 1);
-        return result.str();
-    }
-
     DetailedNode<ErrorNode> * read_error_end() {
         auto start = input.get_offset();
-        auto visualization = visualize();
 
-        while (is_non_operator(input.peek())) {
-            input.step();
-        }
+        input.step(orders::scan_identifier(input.get_current(), input.get_end()));
 
-        session.reporter << BadTokenDiagnostic{
-            .filename = filename,
-            .line_number = line_number,
+        reporter << BadTokenDiagnostic{
+            .file = file,
             .range = {start, input.get_offset()},
-            .visualization = visualization,
             .found = input.revise_all()
         };
 
@@ -303,20 +223,12 @@ struct ParsingContextBackend {
     DetailedNode<ErrorNode> * read_error() {
         prepare();
         auto start = input.get_offset();
-        auto visualization = visualize();
 
-        while (
-            input.has_next() &&
-            !is_space(input.peek())
-        ) {
-            input.step();
-        }
+        input.step(orders::scan_non_spaces(input.get_current(), input.get_end()));
 
-        session.reporter << BadTokenDiagnostic{
-            .filename = filename,
-            .line_number = line_number,
+        reporter << BadTokenDiagnostic{
+            .file = file,
             .range = {start, input.get_offset()},
-            .visualization = visualization,
             .found = input.revise_all()
         };
 
@@ -328,169 +240,79 @@ struct ParsingContextBackend {
     }
 
 
-    int read_sign() {
-        if (input.peek() == '-') {
-            return -1;
-        }
-
-        if (input.peek() == '+') {
-            return 1;
-        }
-
-        return 1;
-    }
-
-    struct Binary {
-        static const int base = 2;
-
-        static int decode(char it) {
-            return it - '0';
-        }
-
-        static bool test(char it) {
-            return is_binary_digit(it);
-        }
-    };
-
-    struct Octal {
-        static const int base = 8;
-
-        static int decode(char it) {
-            return it - '0';
-        }
-
-        static bool test(char it) {
-            return is_octal_digit(it);
-        }
-    };
-
-    struct Decimal {
-        static const int base = 10;
-
-        static int decode(char it) {
-            return it - '0';
-        }
-
-        static bool test(char it) {
-            return is_decimal_digit(it);
-        }
-    };
-
-    struct Hexadecimal {
-        static const int base = 16;
-
-        static int decode(char it) {
-            if (is_hexadecimal_uppercase_digit(it)) {
-                return (it - 'A') + 10;
-            } else if (is_hexadecimal_lowercase_digit(it)) {
-                return (it - 'a') + 10;
-            }
-
-            return it - '0';
-        }
-
-        static bool test(char it) {
-            return is_decimal_digit(it) || is_hexadecimal_lowercase_digit(it) || is_hexadecimal_uppercase_digit(it);
-        }
-    };
-
-    template <typename T>
-    int32_t read_integer() {
-        int32_t value = 0;
-
-        while (T::test(input.peek())) {
-            value = (value * T::base) + T::decode(input.peek());
-            input.step();
-        }
-
-        return value;
-    }
-
-    template <typename T>
-    int32_t read_signed_integer() {
-        return read_sign() * read_integer<T>();
-    }
-
-    template <typename T>
-    double read_optional_fraction() {
-        double value = 0.0;
-        double scale = 1.0;
-
-        if (input.peek() == '.') {
-            input.step();
-
-            while (T::test(input.peek())) {
-                scale /= T::base;
-                value += scale * T::decode(input.peek());
-                input.step();
-            }
-        }
-
-        return value;
-    }
-
-    template <typename T>
-    int32_t read_optional_exponent() {
-        if (
-            input.peek() == 'e' ||
-            input.peek() == 'E'
-        ) {
-            input.step();
-            return read_signed_integer<T>();
-        }
-
-        return 0;
-    }
+    Probably<NumberLiteralNode> read_number(int base) {
+        auto start = input.get_offset();
+        auto number = orders::parse_number(input.get_current(), input.get_end(), base);
 
-    template <typename T>
-    Probably<NumberLiteralNode> read_number() {
-        int sign = read_sign();
-        int32_t integer = read_integer<T>();
-        double fraction = read_optional_fraction<T>();
-        int32_t exponent = read_optional_exponent<T>();
+        input.step(number.length);
 
         if (is_non_operator(input.peek())) {
             return read_error_end();
         }
 
-        if (fraction == 0.0 && exponent == 0) {
-            indent_index = 0;
+        if (number.is_overflow) {
+            reporter << NumberOverflowDiagnostic{
+                .file = file,
+                .range = {start, input.get_offset()},
+                .found = input.revise_all(),
+                .is_real = number.is_real
+            };
+        }
+
+        indent_index = 0;
 
+        if (!number.is_real) {
             return $ NumberLiteralNode{
                 .value = input.revise_all(),
-                .calculated = integer
+                .calculated = number.integer
             };
         }
 
-        indent_index = 0;
-
         return $ NumberLiteralNode{
             .value = input.revise_all(),
-            .calculated = sign * (integer + fraction) * pow(T::base, (double) exponent)
+            .calculated = number.real
         };
     }
 
 
-    bool read_operator(const std::string & lexeme) {
-        prepare();
+    /**
+     * Reads the operator if it's the
+     * longest one at the current position.
+     */
+    bool read_operator(Operator it) {
+        auto found = peek_operator();
 
-        if (input.match(lexeme.c_str())) {
-            input.step(lexeme.size());
-            indent_index = 0;
+        if (found.kind == it) {
+            skip_operator(found);
             return true;
         }
 
         return false;
     }
 
-    bool read_keyword(const std::string & lexeme) {
+    /**
+     * The longest operator at the current
+     * position, doesn't consume it.
+     */
+    OperatorMatch peek_operator() {
         prepare();
+        return match_operator(input.get_current(), input.get_end());
+    }
 
-        auto tail = input.lookahead(lexeme.size());
+    void skip_operator(OperatorMatch it) {
+        input.step(it.length);
+        indent_index = 0;
+    }
+
+    bool read_keyword(const char * lexeme) {
+        prepare();
+
+        auto length = std::strlen(lexeme);
+        auto tail = input.lookahead(length);
         bool is_valid_tail = !is_non_operator(tail) || is_blank(tail) || is_special(tail);
 
-        if (input.match(lexeme.c_str()) && is_valid_tail) {
-            input.step(lexeme.size());
+        if (input.match(lexeme) && is_valid_tail) {
+            input.step(length);
             indent_index = 0;
             return true;
         }
@@ -505,15 +327,16 @@ struct ParsingContextBackend {
 
     Probably<IdentifierNode> read_identifier() {
         input.step();
-
-        while (is_non_operator(input.peek())) {
-            input.step();
-        }
+        input.step(orders::scan_identifier(input.get_current(), input.get_end()));
 
         indent_index = 0;
 
+        auto value = input.revise_all();
+        auto symbol = session.interner.intern(value);
+
         return IdentifierNode{
-            .value = input.revise_all()
+            .value = std::move(value),
+            .symbol = symbol
         };
     }
 
@@ -558,11 +381,9 @@ struct ParsingContextBackend {
         if (input.peek() != '\'') {
             auto it = input.peek();
 
-            session.reporter << SingleQuoteExpectedDiagnostic{
-                .filename = filename,
-                .line_number = line_number,
+            reporter << SingleQuoteExpectedDiagnostic{
+                .file = file,
                 .range = {input.get_offset(), input.get_offset() + 1},
-                .visualization = visualize(),
                 .found = (char) it,
                 .whole_token = '\'' + input.revise_all()
             };
@@ -595,7 +416,7 @@ struct ParsingContextBackend {
 
     Probably<NumberLiteralNode> read_binary() {
         input.step();
-        return read_number<Binary>();
+        return read_number(2);
     }
 
     bool is_octal() {
@@ -605,7 +426,7 @@ struct ParsingContextBackend {
 
     Probably<NumberLiteralNode> read_octal() {
         input.step();
-        return read_number<Octal>();
+        return read_number(8);
     }
 
     bool is_decimal() {
@@ -614,7 +435,7 @@ struct ParsingContextBackend {
     }
 
     Probably<NumberLiteralNode> read_decimal() {
-        return read_number<Decimal>();
+        return read_number(10);
     }
 
     bool is_hexadecimal() {
@@ -624,7 +445,7 @@ struct ParsingContextBackend {
 
     Probably<NumberLiteralNode> read_hexadecimal() {
         input.step();
-        return read_number<Hexadecimal>();
+        return read_number(16);
     }
 
     bool read_indent() {
@@ -655,18 +476,15 @@ struct ParsingContextBackend {
     }
 
 
-    void match(const char * operator_token, OperatorExpectedDiagnostic::Hint hint) {
-        if (!read_operator(operator_token)) {
+    void match(Operator operation, OperatorExpectedDiagnostic::Hint hint) {
+        if (!read_operator(operation)) {
             auto start = input.get_offset();
-            auto visualization = visualize();
             auto it = read_error();
 
-            session.reporter << OperatorExpectedDiagnostic{
-                .filename = filename,
-                .line_number = line_number,
+            reporter << OperatorExpectedDiagnostic{
+                .file = file,
                 .range = {start, input.get_offset()},
-                .visualization = visualization,
-                .operator_token = operator_token,
+                .operator_token = get_lexeme(operation),
                 .hint = hint
             };
         }
@@ -679,14 +497,11 @@ struct ParsingContextBackend {
         }
 
         auto start = input.get_offset();
-        auto visualization = visualize();
         auto error = read_error();
 
-        session.reporter << AnotherTokenTypeExpectedDiagnostic{
-            .filename = filename,
-            .line_number = line_number,
+        reporter << AnotherTokenTypeExpectedDiagnostic{
+            .file = file,
             .range = {start, input.get_offset()},
-            .visualization = visualization,
             .expected = "IDENTIFIER",
             .token = error->details.value,
             .hint = error_hint
@@ -700,7 +515,7 @@ struct ParsingContextBackend {
         auto it = NodeList();
         it.values.push_back(parse_identifier(error_hint).any);
 
-        while (read_operator(",")) {
+        while (read_operator(Operator::COMMA)) {
             it.values.push_back(parse_identifier(error_hint).any);
         }
 
@@ -710,12 +525,12 @@ struct ParsingContextBackend {
     Node * parse_qualified_access(AnotherTokenTypeExpectedDiagnostic::Hint error_hint) {
         Node * it = parse_identifier(error_hint).any;
 
-        if (read_operator(".")) {
+        if (read_operator(Operator::DOT)) {
             auto that = QualifiedAccessNode{ .identifiers = $ NodeList() };
             that.identifiers->details.values.push_back(it);
             that.identifiers->details.values.push_back(parse_identifier(error_hint).any);
 
-            while (read_operator(".")) {
+            while (read_operator(Operator::DOT)) {
                 that.identifiers->details.values.push_back(parse_identifier(error_hint).any);
             }
 
@@ -726,9 +541,9 @@ struct ParsingContextBackend {
     }
 
     Node * parse_terminal() {
-        if (read_operator("(")) {
+        if (read_operator(Operator::LEFT_PARENTHESIS)) {
             auto it = parse_expression();
-            match(")", OperatorExpectedDiagnostic::Hint::NESTED_EXPRESSION);
+            match(Operator::RIGHT_PARENTHESIS, OperatorExpectedDiagnostic::Hint::NESTED_EXPRESSION);
             return it;
         }
 
@@ -761,78 +576,65 @@ struct ParsingContextBackend {
         }
 
         auto start = input.get_offset();
-        auto visualization = visualize();
         auto error = read_error();
 
-        session.reporter << ExpressionExpectedDiagnostic{
-            .filename = filename,
-            .line_number = line_number,
+        reporter << ExpressionExpectedDiagnostic{
+            .file = file,
             .range = {start, input.get_offset()},
-            .visualization = visualization,
             .found = error->details.value
         };
 
         return error;
     }
 
-    Node * parse_unary_minus() {
-        if (read_operator("-")) {
+    Node * parse_prefix() {
+        auto found = peek_operator();
+
+        if (is_prefix(found.kind)) {
+            skip_operator(found);
+
             return $ UnaryExpressionNode{
                 .target = parse_terminal(),
-                .operator_token = "-"
+                .operation = found.kind
             };
         }
 
         return parse_terminal();
     }
 
-    Node * parse_multiply() {
-        auto it = parse_unary_minus();
+    /**
+     * Precedence climbing: binds operators at
+     * least as tight as `min_precedence`, so
+     * each operand costs a single call no matter
+     * how many precedence levels there are.
+     */
+    Node * parse_expression(int min_precedence = 1) {
+        auto it = parse_prefix();
 
-        while (
-            read_operator("*") ||
-            read_operator("/")
-        ) {
-            auto operator_lexeme = input.revise_all();
-            auto that = parse_unary_minus();
-            it = $ BinaryExpressionNode{
-                .left = it,
-                .right = that,
-                .operator_token = operator_lexeme
-            };
-        }
+        while (true) {
+            auto found = peek_operator();
+            auto precedence = get_binary_precedence(found.kind);
 
-        return it;
-    }
+            if (precedence == 0 || precedence < min_precedence) {
+                return it;
+            }
 
-    Node * parse_add() {
-        auto it = parse_multiply();
+            skip_operator(found);
 
-        while (
-            read_operator("+") ||
-            read_operator("-")
-        ) {
-            auto operator_lexeme = input.revise_all();
-            auto that = parse_multiply();
+            auto that = parse_expression(is_right_associative(found.kind) ? precedence : precedence + 1);
             it = $ BinaryExpressionNode{
                 .left = it,
                 .right = that,
-                .operator_token = operator_lexeme
+                .operation = found.kind
             };
         }
-
-        return it;
-    }
-
-    Node * parse_expression() {
-        return parse_add();
     }
 
     DetailedNode<NodeList> * parse_expression_list() {
         auto it = NodeList();
         it.values.push_back(parse_expression());
 
-        while (read_operator(",")) {
+        while (read_operator(Operator::COMMA)) {
             it.values.push_back(parse_expression());
         }
 
@@ -842,12 +644,12 @@ struct ParsingContextBackend {
     Node * parse_assignment() {
         Node * it = parse_expression_list();
 
-        while (read_operator("=")) {
+        while (read_operator(Operator::ASSIGN)) {
             auto that = parse_expression_list();
             it = $ BinaryExpressionNode{
                 .left = it,
                 .right = that,
-                .operator_token = "="
+                .operation = Operator::ASSIGN
             };
         }
 
@@ -858,7 +660,7 @@ struct ParsingContextBackend {
         auto it = NodeList();
         it.values.push_back(parse_type());
 
-        while (read_operator(",")) {
+        while (read_operator(Operator::COMMA)) {
             it.values.push_back(parse_type());
         }
 
@@ -866,9 +668,9 @@ struct ParsingContextBackend {
     }
 
     DetailedNode<NodeList> * parse_type_parameters() {
-        if (read_operator("<")) {
+        if (read_operator(Operator::LESS)) {
             auto that = parse_type_list();
-            match(">", OperatorExpectedDiagnostic::Hint::TYPE_PAREMETERS);
+            match(Operator::GREATER, OperatorExpectedDiagnostic::Hint::TYPE_PAREMETERS);
             return that;
         }
 
@@ -885,9 +687,9 @@ struct ParsingContextBackend {
     }
 
     Node * parse_coumpound_type() {
-        if (read_operator("(")) {
+        if (read_operator(Operator::LEFT_PARENTHESIS)) {
             auto compound = parse_type_list();
-            match(")", OperatorExpectedDiagnostic::Hint::COMPOUND_TYPE_LIST);
+            match(Operator::RIGHT_PARENTHESIS, OperatorExpectedDiagnostic::Hint::COMPOUND_TYPE_LIST);
             return compound;
         }
 
@@ -897,11 +699,11 @@ struct ParsingContextBackend {
     Node * parse_type() {
         auto it = parse_coumpound_type();
 
-        if (read_operator("->")) {
+        if (read_operator(Operator::ARROW)) {
             it = $ BinaryExpressionNode{
                 .left = it,
                 .right = parse_type(),
-                .operator_token = "->"
+                .operation = Operator::ARROW
             };
         }
 
@@ -912,11 +714,11 @@ struct ParsingContextBackend {
         auto declaration = VariableDeclarationNode();
         declaration.variables = parse_identifier_list(AnotherTokenTypeExpectedDiagnostic::Hint::VARIABLE_DECLARATION);
 
-        if (read_operator(":")) {
+        if (read_operator(Operator::COLON)) {
             declaration.type = parse_type();
         }
 
-        if (read_operator("=")) {
+        if (read_operator(Operator::ASSIGN)) {
             declaration.values = parse_expression_list();
         }
 
@@ -927,11 +729,11 @@ struct ParsingContextBackend {
         auto declaration = ConstantDeclarationNode();
         declaration.constants = parse_identifier_list(AnotherTokenTypeExpectedDiagnostic::Hint::CONSTANT_DECLARATION);
 
-        if (read_operator(":")) {
+        if (read_operator(Operator::COLON)) {
             declaration.type = parse_type();
         }
 
-        if (read_operator("=")) {
+        if (read_operator(Operator::ASSIGN)) {
             declaration.values = parse_expression_list();
         }
 
@@ -941,7 +743,7 @@ struct ParsingContextBackend {
     Node * parse_typealias_declaration() {
         auto declaration = TypealiasDeclarationNode();
         declaration.type = parse_type();
-        match("=", OperatorExpectedDiagnostic::Hint::TYPE_EQUALS);
+        match(Operator::ASSIGN, OperatorExpectedDiagnostic::Hint::TYPE_EQUALS);
         declaration.value = parse_type();
         return $ declaration;
     }
@@ -970,11 +772,11 @@ struct ParsingContextBackend {
         declaration.variables = $ NodeList();
         declaration.variables->details.values.push_back(parse_identifier(AnotherTokenTypeExpectedDiagnostic::Hint::VARIABLE_DECLARATION).any);
 
-        if (read_operator(":")) {
+        if (read_operator(Operator::COLON)) {
             declaration.type = parse_type();
         }
 
-        if (read_operator("=")) {
+        if (read_operator(Operator::ASSIGN)) {
             declaration.values = $ NodeList();
             declaration.values->details.values.push_back(parse_expression());
         }
@@ -986,7 +788,7 @@ struct ParsingContextBackend {
         auto it = NodeList();
         it.values.push_back(parse_value_parameter_declaration());
 
-        while (read_operator(",")) {
+        while (read_operator(Operator::COMMA)) {
             it.values.push_back(parse_value_parameter_declaration());
         }
 
@@ -997,10 +799,10 @@ struct ParsingContextBackend {
         auto declaration = FunctionStatementNode();
         declaration.name = parse_identifier(AnotherTokenTypeExpectedDiagnostic::Hint::FUNCTION_NAME).any;
 
-        if (read_operator("(")) {
-            if (!read_operator(")")) {
+        if (read_operator(Operator::LEFT_PARENTHESIS)) {
+            if (!read_operator(Operator::RIGHT_PARENTHESIS)) {
                 declaration.value_parameters = parse_value_parameter_declaration_list();
-                match(")", OperatorExpectedDiagnostic::Hint::CLOSING_PARAMETERS);
+                match(Operator::RIGHT_PARENTHESIS, OperatorExpectedDiagnostic::Hint::CLOSING_PARAMETERS);
             } else {
                 declaration.value_parameters = $ NodeList();
             }
@@ -1008,7 +810,7 @@ struct ParsingContextBackend {
             declaration.value_parameters = $ NodeList();
         }
 
-        if (read_operator(":")) {
+        if (read_operator(Operator::COLON)) {
             declaration.return_type = parse_type();
         } else {
             declaration.return_type = nullptr;
@@ -1057,11 +859,9 @@ struct ParsingContextBackend {
 
     void parse_command_without_indent(DetailedNode<NodeList> * commands) {
         if (read_indent()) {
-            session.reporter << UnexpectedIndentDiagnostic{
-                .filename = filename,
-                .line_number = line_number,
+            reporter << UnexpectedIndentDiagnostic{
+                .file = file,
                 .range = {input.get_offset(), input.get_offset() + 1},
-                .visualization = visualize(),
                 .found = input.revise_all(),
                 .type = "INDENT"
             };
@@ -1075,7 +875,9 @@ struct ParsingContextBackend {
         auto commands = $ NodeList();
         parse_command(commands);
 
-        while (!read_end()) {
+        // the rest of the file isn't worth
+        // looking at once the limit is reached
+        while (!read_end() && !reporter.is_limit_reached()) {
             if (read_dedent()) {
                 break;
             }
@@ -1095,28 +897,84 @@ struct ParsingContextBackend {
     DetailedNode<FileNode> * parse() {
         return $ FileNode {
             .filename = filename,
+            .file = file,
             .root = parse_commands()
         };
     }
 };
 
 
+/**
+ * Reads the whole file into memory.
+ */
+static std::string read_source(std::istream & file) {
+    std::string source;
+
+    file.seekg(0, std::ios::end);
+    auto size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    if (size > 0) {
+        source.resize((size_t) size);
+        file.read(source.data(), size);
+        // text mode may shrink \r\n's
+        source.resize((size_t) file.gcount());
+    }
+
+    return source;
+}
+
+
 DetailedNode<FileNode> * cringe::parse_file(Session & session, const std::string & filename) {
-    std::fstream file{filename};
+    threading::Span span{session.tracer, "parse_file"};
+    std::ifstream file{filename};
 
     if (file.fail()) {
         std::cout << "Error > File `" << filename << "` could not be found." << std::endl;
         return nullptr;
     }
 
-    orders::StdStream input{file};
-    orders::AnalyzableStream analyzable_input{input};
+    // the text stays in the session, so that
+    // diagnostics may show it when printed
+    auto id = session.sources.add(filename, read_source(file));
+    auto source = session.sources.get_text(id);
+    span.argument("filename", filename).argument("size", (int64_t) source.size());
+
+    orders::SourceStream input{source};
 
     return ParsingContextBackend{
         .session = session,
+        .reporter = session.reporter,
+        .filename = filename,
+        .file = id,
+        .input = input
+    }.parse();
+}
+
+
+DetailedNode<FileNode> * cringe::reparse_file(Session & session, orders::FileId file) {
+    threading::Span span{session.tracer, "reparse_file"};
+    auto & filename = session.sources.get_filename(file);
+    span.argument("filename", filename);
+
+    orders::SourceStream input{session.sources.get_text(file)};
+    // these have all been reported
+    // during the first parsing
+    orders::DiagnosticReporter ignored;
+
+    auto result = ParsingContextBackend{
+        .session = session,
+        .reporter = ignored,
         .filename = filename,
-        .input = analyzable_input
+        .file = file,
+        .input = input
     }.parse();
+
+    for (auto it : ignored.diagnostics) {
+        delete it;
+    }
+
+    return result;
 }
 
 
@@ -1125,31 +983,19 @@ DetailedNode<GlobalNode> * cringe::parse_files(Session & session, const std::vec
         .files = $ NodeList{}
     };
 
-    if (session.options.no_parallel) {
-        for (auto that = filenames.begin(); that != filenames.end(); that++) {
-            auto it = cringe::parse_file(session, *that);
+    // every file owns its own slot, so the
+    // order doesn't depend on the completion order
+    // and no locking is needed
+    std::vector<DetailedNode<FileNode> *> results(filenames.size(), nullptr);
 
-            if (it != nullptr) {
-                global->details.files->details.values.push_back(it);
-            }
-        }
-    } else {
-        std::mutex global_lock;
-
-        for (auto that = filenames.begin(); that != filenames.end(); that++) {
-            auto filename = *that;
+    threading::parallel_for(session.pool, 0, filenames.size(), 1, [&](size_t that) {
+        results[that] = cringe::parse_file(session, filenames[that]);
+    });
 
-            session.pool->schedule([&, filename]() {
-                auto it = cringe::parse_file(session, filename);
-
-                if (it != nullptr) {
-                    std::lock_guard lock(global_lock);
-                    global->details.files->details.values.push_back(it);
-                }
-            });
+    for (auto it : results) {
+        if (it != nullptr) {
+            global->details.files->details.values.push_back(it);
         }
-
-        session.pool->wait();
     }
 
     return global;
@@ -15,6 +15,12 @@ namespace cringe {
      * Builds an abstract syntax tree for the single file.
      */
     AST::DetailedNode<AST::FileNode> * parse_file(Session & session, const std::string & filename);
+    /**
+     * Builds the tree again from the text kept
+     * in `session.sources`, without reporting
+     * the same errors twice.
+     */
+    AST::DetailedNode<AST::FileNode> * reparse_file(Session & session, orders::FileId file);
     /**
      * Builds an abstract syntax tree for all the files.
      */
@@ -0,0 +1,242 @@
+#include "pipeline.hpp"
+
+#include "ast/scopes.hpp"
+#include "parsing/parser.hpp"
+#include "resolution/summaries.hpp"
+#include "resolution/scope_resolver.hpp"
+#include "resolution/global_declaration_resolver.hpp"
+#include "resolution/deep_declaration_resolver.hpp"
+
+#include <memory>
+#include <algorithm>
+
+#include <threading/parallel.hpp>
+
+
+using namespace cringe;
+using namespace cringe::AST;
+
+
+threading::Task<DetailedNode<FileNode> *> cringe::process_file(Session & session, const std::string & filename, Scope * global_scope) {
+    co_await threading::resume_on(session.pool);
+
+    // files still waiting in the queue
+    // are skipped after too many errors
+    if (session.reporter.is_limit_reached()) {
+        co_return nullptr;
+    }
+
+    auto file = parse_file(session, filename);
+
+    if (file != nullptr) {
+        threading::Span span{session.tracer, "resolve_scopes_file"};
+        span.argument("filename", filename);
+        resolve_scopes(session, file, global_scope);
+    }
+
+    co_return file;
+}
+
+
+/**
+ * Lets the diagnostics of the file go
+ * out as soon as it's processed.
+ */
+static threading::Task<DetailedNode<FileNode> *> process_and_stream(Session & session, size_t index, const std::string & filename, Scope * global_scope) {
+    auto file = co_await process_file(session, filename, global_scope);
+    session.diagnostic_stream->complete(index, file != nullptr ? file->details.file : orders::NO_FILE);
+    co_return file;
+}
+
+
+/**
+ * Awaits all the per-file chains.
+ */
+static threading::Task<std::vector<DetailedNode<FileNode> *>> process_all(Session & session, const std::vector<std::string> & filenames, Scope * global_scope) {
+    std::vector<threading::Task<DetailedNode<FileNode> *>> chains;
+
+    for (size_t it = 0; it < filenames.size(); it++) {
+        if (session.diagnostic_stream != nullptr) {
+            chains.push_back(process_and_stream(session, it, filenames[it], global_scope));
+        } else {
+            chains.push_back(process_file(session, filenames[it], global_scope));
+        }
+    }
+
+    co_return co_await threading::when_all(std::move(chains));
+}
+
+
+DetailedNode<GlobalNode> * cringe::process_files(Session & session, const std::vector<std::string> & filenames) {
+    auto global = new DetailedNode{GlobalNode{
+        .files = new DetailedNode{NodeList()},
+        .scope = Scope::create_global(session)
+    }};
+
+    auto files = threading::sync_wait(process_all(session, filenames, global->details.scope));
+
+    for (auto it : files) {
+        if (it != nullptr) {
+            global->details.files->details.values.push_back(it);
+        }
+    }
+
+    return global;
+}
+
+
+/**
+ * Parses the file only to remember
+ * its global declarations.
+ */
+static threading::Task<FileSummary> summarize_file(Session & session, size_t index, const std::string & filename) {
+    co_await threading::resume_on(session.pool);
+    FileSummary summary;
+
+    if (!session.reporter.is_limit_reached()) {
+        NodeRegion region;
+        DetailedNode<FileNode> * file = nullptr;
+
+        {
+            NodeRegion::Entered entered{&region};
+            file = parse_file(session, filename);
+
+            // the stand-ins would only know
+            // the types written out otherwise
+            if (file != nullptr) {
+                auto scope = Scope::create_global(session);
+                resolve_scopes(session, file, scope);
+                resolve_global_declarations(session, file, scope);
+                infer_global_types(session, file, scope);
+            }
+        }
+
+        if (file != nullptr) {
+            summary = summarize(session, file);
+        }
+    }
+
+    if (session.diagnostic_stream != nullptr) {
+        session.diagnostic_stream->complete(index, summary.file);
+    }
+
+    co_return summary;
+}
+
+
+static threading::Task<std::vector<FileSummary>> summarize_all(Session & session, const std::vector<std::string> & filenames) {
+    std::vector<threading::Task<FileSummary>> chains;
+
+    for (size_t it = 0; it < filenames.size(); it++) {
+        chains.push_back(summarize_file(session, it, filenames[it]));
+    }
+
+    co_return co_await threading::when_all(std::move(chains));
+}
+
+
+Scope * cringe::process_files_streaming(
+    Session & session,
+    const std::vector<std::string> & filenames,
+    const std::vector<FileSummary> & dependencies,
+    const std::function<void(DetailedNode<FileNode> *, const FileSummary &)> & visit_file
+) {
+    auto global_scope = Scope::create_global(session);
+    std::vector<FileSummary> summaries;
+
+    for (auto & it : dependencies) {
+        declare_summary(session, it, global_scope);
+    }
+
+    {
+        threading::Span span{session.tracer, "summarize_files"};
+        summaries = threading::sync_wait(summarize_all(session, filenames));
+    }
+
+    // later files override earlier ones,
+    // as they do in the global resolver
+    for (auto & it : summaries) {
+        declare_summary(session, it, global_scope);
+    }
+
+    if (session.reporter.is_limit_reached()) {
+        return global_scope;
+    }
+
+    // every group reads the same stand-ins
+    // at once, the files report the cycles
+    collapse_typealiases(session, global_scope, false);
+
+    std::vector<FileSummary> resolved(summaries.size());
+
+    // as many trees as there're
+    // workers to resolve them
+    size_t group_size = session.pool != nullptr ? session.pool->get_workers_count() : 1;
+
+    for (size_t start = 0; start < summaries.size(); start += group_size) {
+        auto stop = std::min(start + group_size, summaries.size());
+        std::vector<std::unique_ptr<NodeRegion>> regions;
+        std::vector<DetailedNode<FileNode> *> files(stop - start, nullptr);
+        // reported in the order of
+        // the files once they're done
+        std::vector<orders::DiagnosticReporter> reporters(stop - start);
+
+        for (size_t it = start; it < stop; it++) {
+            regions.push_back(std::make_unique<NodeRegion>());
+        }
+
+        threading::parallel_for(session.pool, start, stop, 1, [&](size_t that) {
+            auto & summary = summaries[that];
+
+            if (summary.file == orders::NO_FILE) {
+                return;
+            }
+
+            threading::Span span{session.tracer, "resolve_file"};
+            span.argument("filename", session.sources.get_filename(summary.file));
+            DetailedNode<FileNode> * file = nullptr;
+
+            {
+                NodeRegion::Entered entered{regions[that - start].get()};
+
+                // the file's own declarations are found
+                // first, the rest only by their summaries
+                file = reparse_file(session, summary.file);
+                auto file_scope = new Scope(global_scope);
+
+                resolve_scopes(session, file, file_scope);
+                resolve_global_declarations(session, file, file_scope);
+                resolve_deep_declarations(session, file, file_scope, reporters[that - start]);
+            }
+
+            resolved[that] = summarize(session, file);
+            files[that - start] = file;
+        });
+
+        for (auto & it : reporters) {
+            for (auto that : it.diagnostics) {
+                session.reporter.add(that);
+            }
+        }
+
+        for (size_t it = start; it < stop; it++) {
+            if (files[it - start] != nullptr) {
+                visit_file(files[it - start], resolved[it]);
+            }
+        }
+    }
+
+    // the stand-ins others have been resolved
+    // against only know the declared types
+    auto resolved_scope = Scope::create_global(session);
+
+    for (auto & it : dependencies) {
+        declare_summary(session, it, resolved_scope);
+    }
+
+    for (auto & it : resolved) {
+        declare_summary(session, it, resolved_scope);
+    }
+
+    return resolved_scope;
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2020 luna_koly
+//
+// Stages chained per file instead of
+// running each over all files at once.
+
+
+#pragma once
+
+#include "session.hpp"
+#include "ast/nodes.hpp"
+#include "resolution/summaries.hpp"
+
+#include <functional>
+
+#include <threading/coroutine.hpp>
+
+
+namespace cringe {
+    /**
+     * Parses the file and builds its scopes on
+     * a pool worker. `global_scope` must exist.
+     */
+    threading::Task<AST::DetailedNode<AST::FileNode> *> process_file(Session & session, const std::string & filename, AST::Scope * global_scope);
+
+    /**
+     * Runs `process_file()` for every file
+     * concurrently. Files keep the input order.
+     */
+    AST::DetailedNode<AST::GlobalNode> * process_files(Session & session, const std::vector<std::string> & filenames);
+
+    /**
+     * Same as `process_files()` plus the resolvers,
+     * but only a few trees exist at a time. Files
+     * are parsed to summarize their declarations
+     * and dropped, then parsed again in groups and
+     * resolved against the summaries, including the
+     * `dependencies` ones. `visit_file` sees each
+     * resolved tree and its summary in the input
+     * order right before the tree is freed. Returns
+     * the global scope with stand-ins for all the
+     * declarations carrying their resolved types.
+     */
+    AST::Scope * process_files_streaming(
+        Session & session,
+        const std::vector<std::string> & filenames,
+        const std::vector<FileSummary> & dependencies,
+        const std::function<void(AST::DetailedNode<AST::FileNode> *, const FileSummary &)> & visit_file
+    );
+}
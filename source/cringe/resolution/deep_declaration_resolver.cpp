@@ -2,12 +2,17 @@
 
 #include "../ast/explorer.hpp"
 #include "../ast/scopes.hpp"
+#include "../ast/type_table.hpp"
 
 #include "../diagnostics.hpp"
 
 #include <stack>
+#include <vector>
+#include <algorithm>
 #include <iostream>
 
+#include <threading/parallel.hpp>
+
 
 using namespace cringe;
 using namespace cringe::AST;
@@ -59,11 +64,7 @@ struct TypeNodeExtractor : public Visitor {
     }
 
     virtual void visit(DetailedNode<TypealiasDeclarationNode> * it) override {
-        auto type = it->details.type;
-
-        if (type != nullptr) {
-            result = extract<TypeNode>(type);
-        }
+        result = it->details.target;
     }
 
     virtual void visit(DetailedNode<VariableDeclarationNode> * it) override {
@@ -86,6 +87,47 @@ DetailedNode<TypeNode> * extract_type_node(Node * node) {
 }
 
 
+static Scope * get_declaring_scope(Scope * scope, Binding binding) {
+    for (uint32_t it = 0; it < binding.depth; it++) {
+        scope = scope->get_parent();
+    }
+
+    return scope;
+}
+
+
+/**
+ * How many type arguments the declaration
+ * expects. Only aliases may declare type
+ * parameters.
+ */
+static size_t count_type_parameters(Node * declaration) {
+    auto alias = declaration != nullptr ? extract<TypealiasDeclarationNode>(declaration) : nullptr;
+    auto parameters = alias != nullptr ? extract_type_parameters(alias) : nullptr;
+
+    if (parameters == nullptr) {
+        return 0;
+    }
+
+    return parameters->details.values.size();
+}
+
+
+/**
+ * What instantiations are keyed by,
+ * nullptr if the type can't be a part
+ * of a shared one.
+ */
+static const Node * get_canonical(DetailedNode<TypeNode> * type) {
+    if (type->details.is_shared) {
+        return type;
+    }
+
+    auto is_simple = type->details.subtypes == nullptr || type->details.subtypes->details.values.empty();
+    return is_simple ? type->details.declaration : nullptr;
+}
+
+
 struct DeepDeclarationResolver : public Explorer {
     /**
      * Common things, u know.
@@ -101,15 +143,101 @@ struct DeepDeclarationResolver : public Explorer {
      * with the visitor pattern.
      */
     std::stack<DetailedNode<TypeNode> *> declarations;
+    /**
+     * Stand-ins repeat the declarations of
+     * the files, which report cycles themselves.
+     */
+    bool should_report_cycles = true;
+    /**
+     * The global resolver has registered its
+     * declarations already, and other files
+     * may be reading it at the same time.
+     */
+    Scope * shared_scope = nullptr;
+    /**
+     * Where the global resolver has
+     * registered the top-level names.
+     */
+    Scope * global_scope = nullptr;
+    /**
+     * Where the diagnostics go.
+     */
+    orders::DiagnosticReporter * reporter;
+    /**
+     * If set, the diagnostics are held back here
+     * along with the index of the statement they
+     * come from, rather than reported right away.
+     */
+    std::vector<std::pair<size_t, orders::Diagnostic *>> * held_back = nullptr;
+    /**
+     * The top-level statement being resolved.
+     */
+    size_t statement = 0;
+    /**
+     * The file being resolved, the
+     * diagnostics refer to it.
+     */
+    orders::FileId file = orders::NO_FILE;
+    /**
+     * Whether instantiations of global types
+     * go to the session's cache. Not when the
+     * "global" scope is freed with the tree.
+     */
+    bool should_share_instantiations = true;
 
 
-    DeepDeclarationResolver(Session & session) : session(session) {}
+    DeepDeclarationResolver(Session & session) : session(session), reporter(&session.reporter) {}
+
+    /**
+     * Reports right away or holds
+     * the diagnostic back.
+     */
+    template <typename D>
+    void report(D && diagnostic) {
+        diagnostic.file = file;
+
+        if (held_back == nullptr) {
+            *reporter << std::move(diagnostic);
+        } else {
+            held_back->emplace_back(statement, new orders::DetailedDiagnostic<D>{std::move(diagnostic)});
+        }
+    }
+
+    /**
+     * Registers the declaration in
+     * the current scope if it's ours.
+     */
+    void declare(DetailedNode<IdentifierNode> * name, Node * declaration) {
+        if (scopes.top() != shared_scope) {
+            scopes.top()->add(name->details.symbol, declaration);
+        }
+    }
+
+    /**
+     * Blocks without scopes of their
+     * own share the enclosing one.
+     */
+    void enter(Scope * scope) {
+        scopes.push(scope != nullptr ? scope : scopes.top());
+    }
+
+    /**
+     * Returns the type of the node and
+     * records it if the session keeps them.
+     */
+    void put(Node * node, DetailedNode<TypeNode> * type) {
+        declarations.push(type);
+
+        if (session.types != nullptr) {
+            session.types->set(node, type);
+        }
+    }
 
 
     virtual void visit(Node * it) override {
         std::cout << "!!DeepDeclarationResolver wasn't implemented for `" << *it << "`!!" << std::endl;
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"[UNIMPLEMENTED]"},
             .subtypes = $ NodeList()
         });
@@ -131,16 +259,21 @@ struct DeepDeclarationResolver : public Explorer {
             };
         }
 
-        declarations.push(last);
+        put(it, last);
     }
 
     virtual void visit(AST::DetailedNode<AST::ErrorNode> * it) override {
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"[ERROR]"},
             .subtypes = $ NodeList()
         });
     }
 
+    virtual void visit(DetailedNode<FileNode> * it) override {
+        file = it->details.file;
+        it->details.root->accept(this);
+    }
+
     virtual void visit(DetailedNode<GlobalNode> * it) override {
         scopes.push(it->details.scope);
 
@@ -171,7 +304,7 @@ struct DeepDeclarationResolver : public Explorer {
 
         it->details.type = type;
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"Unit"},
             .subtypes = $ NodeList()
         });
@@ -184,30 +317,144 @@ struct DeepDeclarationResolver : public Explorer {
             auto name = extract<IdentifierNode>(names[that]);
 
             if (name != nullptr) {
-                scopes.top()->add(name->details.value, it);
+                declare(name, it);
             } else {
                 std::cout << "!!DeepDeclarationResolver encountered a non-identifier as a constant name name: `" << *names[that] << "`!!" << std::endl;
             }
         }
     }
 
+    /**
+     * The alias the value of this one names
+     * directly, if any. It's looked up in the
+     * scope the value belongs to.
+     */
+    DetailedNode<TypealiasDeclarationNode> * find_next_alias(DetailedNode<TypealiasDeclarationNode> * alias, Scope * scope) {
+        auto type = alias->details.value != nullptr ? extract<TypeNode>(alias->details.value) : nullptr;
+
+        if (type == nullptr || (type->details.subtypes != nullptr && !type->details.subtypes->details.values.empty())) {
+            return nullptr;
+        }
+
+        auto name = extract<IdentifierNode>(type->details.identifier);
+
+        if (name == nullptr) {
+            return nullptr;
+        }
+
+        auto found = scope->bind(session, name);
+        auto next = found != nullptr ? extract<TypealiasDeclarationNode>(found) : nullptr;
+
+        if (next != nullptr && next->details.enclosing_scope == nullptr) {
+            next->details.enclosing_scope = get_declaring_scope(scope, name->details.binding);
+        }
+
+        // a generic one named without arguments
+        // is reported when the value is resolved
+        if (next != nullptr && extract_type_parameters(next) != nullptr) {
+            return nullptr;
+        }
+
+        return next;
+    }
+
+    /**
+     * Follows the chain of aliases to the type
+     * at its end, then makes every alias on the
+     * way refer to that type directly, so the
+     * next use takes a single step.
+     */
+    DetailedNode<TypeNode> * collapse(DetailedNode<TypealiasDeclarationNode> * alias) {
+        std::vector<DetailedNode<TypealiasDeclarationNode> *> chain;
+        DetailedNode<TypeNode> * result = nullptr;
+        auto current = alias;
+
+        while (result == nullptr) {
+            if (current->details.target != nullptr) {
+                result = current->details.target;
+                break;
+            }
+
+            if (current->details.is_collapsing) {
+                auto name = extract_typealias_name(current);
+
+                if (should_report_cycles) {
+                    report(TypealiasCycleDiagnostic{
+                        .name = name != nullptr ? name->details.value : "[UNNAMED]"
+                    });
+                }
+
+                result = $ TypeNode{
+                    .identifier = $ IdentifierNode{"[TYPEALIAS_CYCLE]"},
+                    .subtypes = $ NodeList()
+                };
+                break;
+            }
+
+            current->details.is_collapsing = true;
+            chain.push_back(current);
+
+            auto scope = current->details.enclosing_scope;
+
+            if (current->details.scope != nullptr) {
+                scope = current->details.scope;
+            } else if (scope == nullptr) {
+                scope = scopes.top();
+            }
+
+            auto next = find_next_alias(current, scope);
+
+            if (next != nullptr) {
+                current = next;
+            } else if (current->details.value != nullptr) {
+                // other aliases inside the value
+                // are collapsed on their own
+                scopes.push(scope);
+                current->details.value->accept(this);
+                scopes.pop();
+
+                result = declarations.top();
+                declarations.pop();
+            } else {
+                result = $ TypeNode{
+                    .identifier = $ IdentifierNode{"[ERROR]"},
+                    .subtypes = $ NodeList()
+                };
+            }
+        }
+
+        for (auto it : chain) {
+            it->details.target = result;
+            it->details.is_collapsing = false;
+        }
+
+        return result;
+    }
+
     virtual void visit(AST::DetailedNode<AST::TypealiasDeclarationNode> * it) override {
-        it->details.value->accept(this);
-        auto new_value = declarations.top();
-        declarations.pop();
-        it->details.value = new_value;
+        if (it->details.enclosing_scope == nullptr) {
+            it->details.enclosing_scope = scopes.top();
+        }
+
+        it->details.value = collapse(it);
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"Unit"},
             .subtypes = $ NodeList()
         });
 
         // REGISTER
 
-        auto name = extract<IdentifierNode>(it->details.type);
+        auto name = extract_typealias_name(it);
 
+        // the global aliases have been registered
+        // and collapsed before, registering them
+        // again would switch the redeclared ones
+        // back and forth
         if (name != nullptr) {
-            scopes.top()->add(name->details.value, it);
+            if (scopes.top() != global_scope) {
+                scopes.top()->add(name->details.symbol, it);
+            }
         } else {
             std::cout << "!!DeepDeclarationResolver has no implementation for non-identifier type aliases names: `" << *it->details.type << "`!!" << std::endl;
         }
@@ -235,7 +482,7 @@ struct DeepDeclarationResolver : public Explorer {
 
         it->details.type = type;
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"Unit"},
             .subtypes = $ NodeList()
         });
@@ -248,7 +495,7 @@ struct DeepDeclarationResolver : public Explorer {
             auto name = extract<IdentifierNode>(names[that]);
 
             if (name != nullptr) {
-                scopes.top()->add(name->details.value, it);
+                declare(name, it);
             } else {
                 std::cout << "!!DeepDeclarationResolver encountered a non-identifier as a variable name name: `" << *names[that] << "`!!" << std::endl;
             }
@@ -262,7 +509,7 @@ struct DeepDeclarationResolver : public Explorer {
         it->details.right->accept(this);
         declarations.pop();
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"[BINARY]"},
             .subtypes = $ NodeList()
         });
@@ -272,20 +519,23 @@ struct DeepDeclarationResolver : public Explorer {
         it->details.target->accept(this);
         declarations.pop();
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"[UNARY]"},
             .subtypes = $ NodeList()
         });
     }
 
     virtual void visit(AST::DetailedNode<AST::QualifiedAccessNode> * it) override {
-        auto that = scopes.top()->resolve(session, it);
+        auto that = scopes.top()->bind(session, it);
+        auto alias = that != nullptr ? extract<TypealiasDeclarationNode>(that) : nullptr;
 
-        if (that != nullptr) {
+        if (alias != nullptr) {
+            put(it, collapse(alias));
+        } else if (that != nullptr) {
             auto type = extract_type_node(that);
 
             if (type != nullptr) {
-                declarations.push($ TypeNode{
+                put(it, $ TypeNode{
                     .identifier = type->details.identifier,
                     .declaration = that
                 });
@@ -293,15 +543,11 @@ struct DeepDeclarationResolver : public Explorer {
                 std::stringstream rendered;
                 it->print(rendered);
 
-                session.reporter << InaccessibleTypeInformationDiagnostic{
-                    .filename = "[MISSING_FILENAME]",
-                    .line_number = 0,
-                    .range = {0, 0},
-                    .visualization = "[MISSING_VISUALIZATION]",
+                report(InaccessibleTypeInformationDiagnostic{
                     .accessor = rendered.str()
-                };
+                });
 
-                declarations.push($ TypeNode{
+                put(it, $ TypeNode{
                     .identifier = $ IdentifierNode{"[DECLARATION_WITHOUT_TYPE]"},
                     .subtypes = $ NodeList()
                 });
@@ -310,15 +556,11 @@ struct DeepDeclarationResolver : public Explorer {
             std::stringstream rendered;
             it->print(rendered);
 
-            session.reporter << UnresolvedReferenceDiagnostic{
-                .filename = "[MISSING_FILENAME]",
-                .line_number = 0,
-                .range = {0, 0},
-                .visualization = "[MISSING_VISUALIZATION]",
+            report(UnresolvedReferenceDiagnostic{
                 .accessor = rendered.str()
-            };
+            });
 
-            declarations.push($ TypeNode{
+            put(it, $ TypeNode{
                 .identifier = $ IdentifierNode{"[UNRESOLVED_REFERENCE]"},
                 .subtypes = $ NodeList()
             });
@@ -326,20 +568,26 @@ struct DeepDeclarationResolver : public Explorer {
     }
 
     virtual void visit(AST::DetailedNode<AST::CharacterLiteralNode> * it) override {
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"Char"},
             .subtypes = $ NodeList()
         });
     }
 
     virtual void visit(AST::DetailedNode<AST::IdentifierNode> * it) override {
-        auto that = scopes.top()->resolve(session, it);
+        auto that = scopes.top()->bind(session, it);
+        auto alias = that != nullptr ? extract<TypealiasDeclarationNode>(that) : nullptr;
 
-        if (that != nullptr) {
+        if (alias != nullptr) {
+            put(it, collapse(alias));
+        } else if (that != nullptr) {
             auto type = extract_type_node(that);
 
-            if (type != nullptr) {
-                declarations.push($ TypeNode{
+            // the uses share it too
+            if (type != nullptr && type->details.is_shared) {
+                put(it, type);
+            } else if (type != nullptr) {
+                put(it, $ TypeNode{
                     .identifier = type->details.identifier,
                     .subtypes = type->details.subtypes,
                     .declaration = that
@@ -348,15 +596,11 @@ struct DeepDeclarationResolver : public Explorer {
                 std::stringstream rendered;
                 it->print(rendered);
 
-                session.reporter << InaccessibleTypeInformationDiagnostic{
-                    .filename = "[MISSING_FILENAME]",
-                    .line_number = 0,
-                    .range = {0, 0},
-                    .visualization = "[MISSING_VISUALIZATION]",
+                report(InaccessibleTypeInformationDiagnostic{
                     .accessor = rendered.str()
-                };
+                });
 
-                declarations.push($ TypeNode{
+                put(it, $ TypeNode{
                     .identifier = $ IdentifierNode{"[DECLARATION_WITHOUT_TYPE]"},
                     .subtypes = $ NodeList()
                 });
@@ -365,15 +609,11 @@ struct DeepDeclarationResolver : public Explorer {
             std::stringstream rendered;
             it->print(rendered);
 
-            session.reporter << UnresolvedReferenceDiagnostic{
-                .filename = "[MISSING_FILENAME]",
-                .line_number = 0,
-                .range = {0, 0},
-                .visualization = "[MISSING_VISUALIZATION]",
+            report(UnresolvedReferenceDiagnostic{
                 .accessor = rendered.str()
-            };
+            });
 
-            declarations.push($ TypeNode{
+            put(it, $ TypeNode{
                 .identifier = $ IdentifierNode{"[UNRESOLVED_REFERENCE]"},
                 .subtypes = $ NodeList()
             });
@@ -381,13 +621,13 @@ struct DeepDeclarationResolver : public Explorer {
     }
 
     virtual void visit(AST::DetailedNode<AST::NumberLiteralNode> * it) override {
-        if (std::holds_alternative<int>(it->details.calculated)) {
-            declarations.push($ TypeNode{
+        if (std::holds_alternative<int64_t>(it->details.calculated)) {
+            put(it, $ TypeNode{
                 .identifier = $ IdentifierNode{"Int"},
                 .subtypes = $ NodeList()
             });
         } else {
-            declarations.push($ TypeNode{
+            put(it, $ TypeNode{
                 .identifier = $ IdentifierNode{"Real"},
                 .subtypes = $ NodeList()
             });
@@ -395,22 +635,156 @@ struct DeepDeclarationResolver : public Explorer {
     }
 
     virtual void visit(AST::DetailedNode<AST::StringLiteralNode> * it) override {
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"String"},
             .subtypes = $ NodeList()
         });
     }
 
+    /**
+     * Whether the type is named by an identifier
+     * declared in the global scope, which lives
+     * as long as the session does.
+     */
+    bool is_named_globally(Node * type) {
+        auto that = extract<TypeNode>(type);
+        auto name = that != nullptr ? extract<IdentifierNode>(that->details.identifier) : nullptr;
+
+        if (name == nullptr || name->details.binding.is_none()) {
+            return false;
+        }
+
+        return get_declaring_scope(scopes.top(), name->details.binding)->get_parent() == nullptr;
+    }
+
+    /**
+     * Resolves `Base<Arguments...>`. If all of
+     * its parts are declared globally, every
+     * occurrence gets the same TypeNode. Generic
+     * aliases are kept as they are, not expanded.
+     */
+    DetailedNode<TypeNode> * instantiate(DetailedNode<TypeNode> * it, DetailedNode<IdentifierNode> * name) {
+        auto declaration = scopes.top()->bind(session, name);
+        auto parameters_count = count_type_parameters(declaration);
+        DetailedNode<TypeNode> * base = nullptr;
+
+        // resolved as usual to report what's wrong
+        // with it, generic aliases are only named
+        if (parameters_count == 0) {
+            name->accept(this);
+            base = declarations.top();
+            declarations.pop();
+        }
+
+        InstantiationCache::Key key{declaration};
+        auto is_global = should_share_instantiations && is_named_globally(it);
+        std::vector<DetailedNode<TypeNode> *> arguments;
+
+        for (auto that : it->details.subtypes->details.values) {
+            that->accept(this);
+            arguments.push_back(declarations.top());
+            declarations.pop();
+
+            key.push_back(get_canonical(arguments.back()));
+            is_global = is_global && key.back() != nullptr && (arguments.back()->details.is_shared || is_named_globally(that));
+        }
+
+        // the base couldn't be resolved,
+        // that's been reported already
+        if (base != nullptr && base->details.declaration == nullptr) {
+            return base;
+        }
+
+        if (parameters_count != arguments.size()) {
+            report(TypeArgumentsCountDiagnostic{
+                .name = name->details.value,
+                .expected = parameters_count,
+                .found = arguments.size()
+            });
+
+            return $ TypeNode{
+                .identifier = $ IdentifierNode{"[INVALID_TYPE_ARGUMENTS]"},
+                .subtypes = $ NodeList()
+            };
+        }
+
+        if (!is_global) {
+            auto subtypes = $ NodeList();
+
+            for (auto that : arguments) {
+                subtypes->details.values.push_back(that);
+            }
+
+            return $ TypeNode{
+                .identifier = name,
+                .subtypes = subtypes,
+                .declaration = declaration
+            };
+        }
+
+        return session.instantiations.get(key, [&]() {
+            // the files may be freed
+            // long before the session
+            NodeRegion::Entered outside{nullptr};
+            auto subtypes = $ NodeList();
+
+            for (auto that : arguments) {
+                if (that->details.is_shared) {
+                    subtypes->details.values.push_back(that);
+                } else {
+                    subtypes->details.values.push_back($ TypeNode{
+                        .identifier = that->details.identifier,
+                        .subtypes = that->details.subtypes,
+                        .declaration = that->details.declaration
+                    });
+                }
+            }
+
+            return $ TypeNode{
+                .identifier = $ IdentifierNode{
+                    .value = name->details.value,
+                    .symbol = name->details.symbol
+                },
+                .subtypes = subtypes,
+                .declaration = declaration,
+                .is_shared = true
+            };
+        });
+    }
+
     virtual void visit(AST::DetailedNode<AST::TypeNode> * it) override {
         auto that = extract<IdentifierNode>(it->details.identifier);
 
-        if (it->details.subtypes->details.values.empty() && that != nullptr) {
+        // stand-ins may have no subtypes
+        auto is_simple = it->details.subtypes == nullptr || it->details.subtypes->details.values.empty();
+
+        if (is_simple && that != nullptr) {
             // delegate calculations
             that->accept(this);
+
+            auto declaration = that->details.binding.is_none() ? nullptr : scopes.top()->get(that->details.binding);
+            auto parameters_count = count_type_parameters(declaration);
+
+            if (parameters_count != 0) {
+                declarations.pop();
+
+                report(TypeArgumentsCountDiagnostic{
+                    .name = that->details.value,
+                    .expected = parameters_count,
+                    .found = 0
+                });
+
+                put(it, $ TypeNode{
+                    .identifier = $ IdentifierNode{"[INVALID_TYPE_ARGUMENTS]"},
+                    .subtypes = $ NodeList()
+                });
+            }
+        } else if (that != nullptr) {
+            put(it, instantiate(it, that));
         } else {
             std::cout << "!!DeepDeclarationResolver has no implementation for non-identifier type nodes names: `" << *it->details.identifier << "`!!" << std::endl;
 
-            declarations.push($ TypeNode{
+            put(it, $ TypeNode{
                 .identifier = $ IdentifierNode{"[DIFFICULT_TYPE]"},
                 .subtypes = $ NodeList()
             });
@@ -421,7 +795,7 @@ struct DeepDeclarationResolver : public Explorer {
         it->details.value_parameters->accept(this);
         declarations.pop();
 
-        scopes.push(it->details.scope);
+        enter(it->details.scope);
         it->details.body->accept(this);
         scopes.pop();
 
@@ -437,7 +811,7 @@ struct DeepDeclarationResolver : public Explorer {
         auto name = extract<IdentifierNode>(it->details.name);
 
         if (name != nullptr) {
-            scopes.top()->add(name->details.value, it);
+            declare(name, it);
         } else {
             std::cout << "!!DeepDeclarationResolver encountered a non-identifier as a function name: `" << *it->details.name << "`!!" << std::endl;
         }
@@ -447,7 +821,7 @@ struct DeepDeclarationResolver : public Explorer {
         it->details.condition->accept(this);
         declarations.pop();
 
-        scopes.push(it->details.scope);
+        enter(it->details.scope);
 
         it->details.on_true->accept(this);
         declarations.pop();
@@ -459,7 +833,7 @@ struct DeepDeclarationResolver : public Explorer {
 
         scopes.pop();
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"Unit"},
             .subtypes = $ NodeList()
         });
@@ -468,13 +842,13 @@ struct DeepDeclarationResolver : public Explorer {
     virtual void visit(DetailedNode<WhileStatementNode> * it) override {
         it->details.condition->accept(this);
 
-        scopes.push(it->details.scope);
+        enter(it->details.scope);
 
         it->details.on_true->accept(this);
 
         scopes.pop();
 
-        declarations.push($ TypeNode{
+        put(it, $ TypeNode{
             .identifier = $ IdentifierNode{"Unit"},
             .subtypes = $ NodeList()
         });
@@ -482,21 +856,208 @@ struct DeepDeclarationResolver : public Explorer {
 };
 
 
+static void collapse_declared_typealiases(DeepDeclarationResolver & resolver, Scope * scope) {
+    for (auto & it : scope->get_declarations()) {
+        auto alias = extract<TypealiasDeclarationNode>(it.second);
+
+        if (alias != nullptr) {
+            if (alias->details.enclosing_scope == nullptr) {
+                alias->details.enclosing_scope = scope;
+            }
+
+            resolver.collapse(alias);
+        }
+    }
+}
+
+void cringe::collapse_typealiases(Session & session, Scope * scope, bool should_report_cycles) {
+    threading::Span span{session.tracer, "collapse_typealiases"};
+    DeepDeclarationResolver resolver{session};
+    resolver.should_report_cycles = should_report_cycles;
+    resolver.scopes.push(scope);
+    collapse_declared_typealiases(resolver, scope);
+}
+
+
+/**
+ * Other files may read the global declarations
+ * and whatever they declare inside, so those
+ * are resolved one file after another first.
+ */
+static bool is_global_declaration(Node * node) {
+    return extract<FunctionStatementNode>(node) != nullptr ||
+        extract<ConstantDeclarationNode>(node) != nullptr ||
+        extract<VariableDeclarationNode>(node) != nullptr ||
+        extract<TypealiasDeclarationNode>(node) != nullptr;
+}
+
+/**
+ * Nested lists declare globally too,
+ * as the global resolver sees it.
+ */
+static void collect_statements(Node * node, std::vector<Node *> & statements) {
+    auto list = extract<NodeList>(node);
+
+    if (list == nullptr) {
+        statements.push_back(node);
+        return;
+    }
+
+    for (auto it : list->details.values) {
+        collect_statements(it, statements);
+    }
+}
+
+/**
+ * What resolving a file reports is held back
+ * until all the files are done, so that the
+ * order doesn't depend on the threads.
+ */
+struct FileResolution {
+    orders::FileId file = orders::NO_FILE;
+    std::vector<Node *> statements;
+    std::vector<std::pair<size_t, orders::Diagnostic *>> held_back;
+};
+
+static void resolve_statements(Session & session, FileResolution & file, Scope * global_scope, bool are_declarations) {
+    DeepDeclarationResolver resolver{session};
+    resolver.global_scope = global_scope;
+    resolver.held_back = &file.held_back;
+    resolver.file = file.file;
+    resolver.scopes.push(global_scope);
+
+    // the declarations go one file at a time, they
+    // may still register what the global resolver
+    // doesn't know about, e.g. the parameters
+    if (!are_declarations) {
+        resolver.shared_scope = global_scope;
+    }
+
+    for (size_t it = 0; it < file.statements.size(); it++) {
+        if (is_global_declaration(file.statements[it]) != are_declarations) {
+            continue;
+        }
+
+        resolver.statement = it;
+        file.statements[it]->accept(&resolver);
+        resolver.declarations.pop();
+    }
+}
+
+
 void cringe::resolve_deep_declarations(Session & session, DetailedNode<GlobalNode> * node) {
-    if (session.options.no_parallel) {
-        DeepDeclarationResolver resolver{session};
-        node->accept(&resolver);
-    } else {
-        for (auto it : node->details.files->details.values) {
-            session.pool->schedule([&, it]() {
-                DeepDeclarationResolver resolver{session};
-                // as long as global scope is not modified,
-                // this is not an issue
-                resolver.scopes.push(node->details.scope);
-                it->accept(&resolver);
-            });
+    threading::Span span{session.tracer, "resolve_deep_declarations"};
+
+    // files only read the global
+    // aliases, never collapse them
+    collapse_typealiases(session, node->details.scope);
+
+    auto & files = node->details.files->details.values;
+    std::vector<FileResolution> resolutions(files.size());
+
+    for (size_t it = 0; it < files.size(); it++) {
+        auto file = extract<FileNode>(files[it]);
+
+        if (file != nullptr) {
+            resolutions[it].file = file->details.file;
+            collect_statements(file->details.root, resolutions[it].statements);
         }
+    }
+
+    {
+        threading::Span span{session.tracer, "resolve_global_declaration_types"};
 
-        session.pool->wait();
+        for (auto & it : resolutions) {
+            resolve_statements(session, it, node->details.scope, true);
+        }
     }
+
+    // the rest declares nothing
+    // other files could see
+    threading::parallel_for(session.pool, 0, files.size(), 1, [&](size_t that) {
+        threading::Span span{session.tracer, "resolve_deep_declarations_file"};
+
+        if (session.tracer != nullptr) {
+            auto file = extract<FileNode>(files[that]);
+
+            if (file != nullptr) {
+                span.argument("filename", file->details.filename);
+            }
+        }
+
+        resolve_statements(session, resolutions[that], node->details.scope, false);
+    });
+
+    for (auto & it : resolutions) {
+        // a file reports in the order
+        // of its statements
+        std::stable_sort(it.held_back.begin(), it.held_back.end(), [](auto & left, auto & right) {
+            return left.first < right.first;
+        });
+
+        for (auto & that : it.held_back) {
+            session.reporter.add(that.second);
+        }
+    }
+
+    span.argument("instantiations", (int64_t) session.instantiations.get_size());
+}
+
+/**
+ * Names of the other files can't be found
+ * yet, so a guess that reports anything
+ * is no good.
+ */
+template <typename T>
+static void infer_type(DeepDeclarationResolver & resolver, DetailedNode<T> * declaration) {
+    if (declaration == nullptr || declaration->details.type != nullptr || declaration->details.values == nullptr) {
+        return;
+    }
+
+    auto reported_count = resolver.held_back->size();
+    declaration->accept(&resolver);
+    resolver.declarations.pop();
+
+    if (resolver.held_back->size() != reported_count) {
+        declaration->details.type = nullptr;
+    }
+}
+
+void cringe::infer_global_types(Session & session, DetailedNode<FileNode> * file, Scope * scope) {
+    std::vector<Node *> statements;
+    collect_statements(file->details.root, statements);
+
+    std::vector<std::pair<size_t, orders::Diagnostic *>> held_back;
+    DeepDeclarationResolver resolver{session};
+    resolver.global_scope = scope;
+    resolver.held_back = &held_back;
+    resolver.should_share_instantiations = false;
+    resolver.scopes.push(scope);
+
+    for (auto it : statements) {
+        infer_type(resolver, extract<ConstantDeclarationNode>(it));
+        infer_type(resolver, extract<VariableDeclarationNode>(it));
+    }
+
+    for (auto & it : held_back) {
+        delete it.second;
+    }
+}
+
+void cringe::resolve_deep_declarations(Session & session, Node * node, Scope * scope, orders::DiagnosticReporter & reporter) {
+    auto file = extract<FileNode>(node);
+
+    DeepDeclarationResolver resolver{session};
+    resolver.reporter = &reporter;
+    resolver.global_scope = scope;
+    resolver.scopes.push(scope);
+
+    // the cycles are reported
+    // against the file too
+    if (file != nullptr) {
+        resolver.file = file->details.file;
+    }
+
+    collapse_declared_typealiases(resolver, scope);
+    node->accept(&resolver);
 }
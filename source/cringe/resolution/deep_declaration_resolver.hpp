@@ -6,6 +6,7 @@
 #pragma once
 
 #include "../ast/visitor.hpp"
+#include "../ast/scopes.hpp"
 #include "../session.hpp"
 
 
@@ -14,4 +15,24 @@ namespace cringe {
      * Resolves the types.
      */
     void resolve_deep_declarations(Session & session, AST::DetailedNode<AST::GlobalNode> * node);
+    /**
+     * Resolves the types of a subtree whose
+     * enclosing scope is `scope`. Diagnostics
+     * go to `reporter`, so that the caller
+     * may order them.
+     */
+    void resolve_deep_declarations(Session & session, AST::Node * node, AST::Scope * scope, orders::DiagnosticReporter & reporter);
+    /**
+     * Collapses the chains of the aliases
+     * declared in the scope. Scopes shared
+     * by threads must be collapsed first.
+     */
+    void collapse_typealiases(Session & session, AST::Scope * scope, bool should_report_cycles = true);
+    /**
+     * Infers the types of the global constants
+     * and variables that have none written, as
+     * far as the file alone tells them. The
+     * file must be resolved for real later.
+     */
+    void infer_global_types(Session & session, AST::DetailedNode<AST::FileNode> * file, AST::Scope * scope);
 }
@@ -46,7 +46,7 @@ struct GlobalDeclarationResolver : public Visitor {
         auto name = extract<IdentifierNode>(it->details.name);
 
         if (name != nullptr) {
-            global_scope->add(name->details.value, it);
+            global_scope->add(name->details.symbol, it);
         } else {
             std::cout << "!!GlobalDeclarationResolver encountered a non-identifier as a function name: `" << *it->details.name << "`!!" << std::endl;
         }
@@ -62,7 +62,7 @@ struct GlobalDeclarationResolver : public Visitor {
                 // if (it->details.values != nullptr && it->details.values->details.values.size() == names.size()) {
                 //     global_scope->add(name->details.value, it->details.values->details.values[that]);
                 // } else {
-                    global_scope->add(name->details.value, it);
+                    global_scope->add(name->details.symbol, it);
                 // }
             } else {
                 std::cout << "!!GlobalDeclarationResolver encountered a non-identifier as a constant name name: `" << *names[that] << "`!!" << std::endl;
@@ -71,10 +71,10 @@ struct GlobalDeclarationResolver : public Visitor {
     }
 
     virtual void visit(DetailedNode<TypealiasDeclarationNode> * it) override {
-        auto name = extract<IdentifierNode>(it->details.type);
+        auto name = extract_typealias_name(it);
 
         if (name != nullptr) {
-            global_scope->add(name->details.value, it);
+            global_scope->add(name->details.symbol, it);
         } else {
             std::cout << "!!GlobalDeclarationResolver has no implementation for non-identifier type aliases names: `" << *it->details.type << "`!!" << std::endl;
         }
@@ -87,7 +87,7 @@ struct GlobalDeclarationResolver : public Visitor {
             auto name = extract<IdentifierNode>(names[that]);
 
             if (name != nullptr) {
-                global_scope->add(name->details.value, it);
+                global_scope->add(name->details.symbol, it);
             } else {
                 std::cout << "!!GlobalDeclarationResolver encountered a non-identifier as a variable name name: `" << *names[that] << "`!!" << std::endl;
             }
@@ -97,6 +97,13 @@ struct GlobalDeclarationResolver : public Visitor {
 
 
 void cringe::resolve_global_declarations(Session & session, AST::Node * node) {
+    threading::Span span{session.tracer, "resolve_global_declarations"};
     GlobalDeclarationResolver resolver{session};
     node->accept(&resolver);
 }
+
+void cringe::resolve_global_declarations(Session & session, AST::Node * node, AST::Scope * scope) {
+    GlobalDeclarationResolver resolver{session};
+    resolver.global_scope = scope;
+    node->accept(&resolver);
+}
@@ -7,6 +7,7 @@
 
 #include "../session.hpp"
 #include "../ast/visitor.hpp"
+#include "../ast/scopes.hpp"
 
 
 namespace cringe {
@@ -14,4 +15,9 @@ namespace cringe {
      * Registers global scope entities.
      */
     void resolve_global_declarations(Session & session, AST::Node * node);
+    /**
+     * Registers the entities of a subtree
+     * in `scope` instead of the global one.
+     */
+    void resolve_global_declarations(Session & session, AST::Node * node, AST::Scope * scope);
 }
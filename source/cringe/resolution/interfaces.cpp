@@ -0,0 +1,374 @@
+#include "interfaces.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+
+using namespace cringe;
+using namespace cringe::AST;
+
+
+/**
+ * Goes first in every interface.
+ */
+static const char MAGIC[] = {'C', 'R', 'G', 'I'};
+
+/**
+ * Bumped whenever the layout changes.
+ */
+static const uint64_t VERSION = 2;
+
+/**
+ * Type trees are never this deep,
+ * unless the file is broken.
+ */
+static const int MAX_DEPTH = 256;
+
+/**
+ * Tags of the type tree nodes.
+ */
+enum class Tag : uint8_t {
+    NONE, TYPE, IDENTIFIER, QUALIFIED_ACCESS, LIST, BINARY, ERROR
+};
+
+
+/**
+ * Lays the summary out as:
+ * magic, version, strings, declarations.
+ * Numbers are LEB128 varints, each string
+ * is stored once and referred by index.
+ */
+struct InterfaceWriter : public Visitor {
+    Session & session;
+
+    std::string body;
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint64_t> indices;
+
+    InterfaceWriter(Session & session) : session(session) {}
+
+    static void write_number(std::string & output, uint64_t value) {
+        while (value >= 0x80) {
+            output += (char) ((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+
+        output += (char) value;
+    }
+
+    void write_byte(uint8_t value) {
+        body += (char) value;
+    }
+
+    void write_string(std::string_view text) {
+        auto found = indices.find(text);
+
+        if (found == indices.end()) {
+            found = indices.emplace(text, strings.size()).first;
+            strings.push_back(text);
+        }
+
+        write_number(body, found->second);
+    }
+
+    void write_type(Node * node) {
+        if (node == nullptr) {
+            write_byte((uint8_t) Tag::NONE);
+        } else {
+            node->accept(this);
+        }
+    }
+
+    virtual void visit(Node * it) override {
+        write_byte((uint8_t) Tag::NONE);
+    }
+
+    virtual void visit(DetailedNode<NodeList> * it) override {
+        write_byte((uint8_t) Tag::LIST);
+        write_number(body, it->details.values.size());
+
+        for (auto that : it->details.values) {
+            write_type(that);
+        }
+    }
+
+    virtual void visit(DetailedNode<ErrorNode> * it) override {
+        write_byte((uint8_t) Tag::ERROR);
+        write_string(it->details.value);
+    }
+
+    virtual void visit(DetailedNode<IdentifierNode> * it) override {
+        write_byte((uint8_t) Tag::IDENTIFIER);
+        write_string(it->details.value);
+    }
+
+    virtual void visit(DetailedNode<QualifiedAccessNode> * it) override {
+        write_byte((uint8_t) Tag::QUALIFIED_ACCESS);
+        write_type(it->details.identifiers);
+    }
+
+    virtual void visit(DetailedNode<BinaryExpressionNode> * it) override {
+        write_byte((uint8_t) Tag::BINARY);
+        write_byte((uint8_t) it->details.operation);
+        write_type(it->details.left);
+        write_type(it->details.right);
+    }
+
+    virtual void visit(DetailedNode<TypeNode> * it) override {
+        write_byte((uint8_t) Tag::TYPE);
+        write_type(it->details.identifier);
+        write_type(it->details.subtypes);
+    }
+
+    std::string write(const FileSummary & summary) {
+        write_number(body, summary.declarations.size());
+
+        for (auto & it : summary.declarations) {
+            write_byte((uint8_t) it.kind);
+            write_string(session.interner.get_text(it.name));
+            write_type(it.type);
+            write_number(body, it.type_parameters.size());
+
+            for (auto that : it.type_parameters) {
+                write_string(session.interner.get_text(that));
+            }
+        }
+
+        std::string result(MAGIC, sizeof(MAGIC));
+        write_number(result, VERSION);
+        write_number(result, strings.size());
+
+        for (auto it : strings) {
+            write_number(result, it.size());
+            result += it;
+        }
+
+        return result + body;
+    }
+};
+
+
+bool cringe::write_interface(Session & session, const FileSummary & summary, const std::string & path) {
+    threading::Span span{session.tracer, "write_interface"};
+    span.argument("path", path);
+
+    std::ofstream file{path, std::ios::binary};
+
+    if (file.fail()) {
+        return false;
+    }
+
+    auto data = InterfaceWriter{session}.write(summary);
+    file.write(data.data(), data.size());
+    return !file.fail();
+}
+
+
+/**
+ * Reads what InterfaceWriter has written,
+ * any inconsistency makes it fail.
+ */
+struct InterfaceReader {
+    Session & session;
+    std::string_view data;
+
+    size_t position = 0;
+    bool is_broken = false;
+    std::vector<std::string> strings;
+
+    uint8_t read_byte() {
+        if (position >= data.size()) {
+            is_broken = true;
+            return 0;
+        }
+
+        return (uint8_t) data[position++];
+    }
+
+    uint64_t read_number() {
+        uint64_t result = 0;
+
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto it = read_byte();
+            result |= (uint64_t) (it & 0x7F) << shift;
+
+            if ((it & 0x80) == 0) {
+                return result;
+            }
+        }
+
+        is_broken = true;
+        return 0;
+    }
+
+    const std::string & read_string() {
+        static const std::string EMPTY;
+        auto index = read_number();
+
+        if (index >= strings.size()) {
+            is_broken = true;
+            return EMPTY;
+        }
+
+        return strings[index];
+    }
+
+    DetailedNode<NodeList> * read_list(int depth) {
+        auto count = read_number();
+        auto list = new DetailedNode{NodeList()};
+
+        // every item takes at least a byte
+        if (count > data.size() - position) {
+            is_broken = true;
+            return list;
+        }
+
+        for (uint64_t it = 0; it < count && !is_broken; it++) {
+            list->details.values.push_back(read_type(depth + 1));
+        }
+
+        return list;
+    }
+
+    /**
+     * Expects the list tag, nullptr
+     * is allowed as well.
+     */
+    DetailedNode<NodeList> * read_list_or_none(int depth) {
+        auto tag = (Tag) read_byte();
+
+        if (tag == Tag::NONE) {
+            return nullptr;
+        }
+
+        if (tag != Tag::LIST) {
+            is_broken = true;
+            return nullptr;
+        }
+
+        return read_list(depth);
+    }
+
+    Node * read_type(int depth) {
+        if (depth > MAX_DEPTH) {
+            is_broken = true;
+            return nullptr;
+        }
+
+        switch ((Tag) read_byte()) {
+            case Tag::NONE:
+                return nullptr;
+            case Tag::TYPE: {
+                auto identifier = read_type(depth + 1);
+                return new DetailedNode{TypeNode{
+                    .identifier = identifier,
+                    .subtypes = read_list_or_none(depth + 1)
+                }};
+            }
+            case Tag::IDENTIFIER: {
+                auto & name = read_string();
+                return new DetailedNode{IdentifierNode{
+                    .value = name,
+                    .symbol = session.interner.intern(name)
+                }};
+            }
+            case Tag::QUALIFIED_ACCESS:
+                return new DetailedNode{QualifiedAccessNode{
+                    .identifiers = read_list_or_none(depth + 1)
+                }};
+            case Tag::LIST:
+                return read_list(depth);
+            case Tag::BINARY: {
+                auto operation = read_byte();
+
+                if (operation > (uint8_t) Operator::GREATER) {
+                    is_broken = true;
+                    return nullptr;
+                }
+
+                auto left = read_type(depth + 1);
+                return new DetailedNode{BinaryExpressionNode{
+                    .left = left,
+                    .right = read_type(depth + 1),
+                    .operation = (Operator) operation
+                }};
+            }
+            case Tag::ERROR:
+                return new DetailedNode{ErrorNode{read_string()}};
+        }
+
+        is_broken = true;
+        return nullptr;
+    }
+
+    bool read(FileSummary & summary) {
+        if (data.compare(0, sizeof(MAGIC), std::string_view(MAGIC, sizeof(MAGIC))) != 0) {
+            return false;
+        }
+
+        position = sizeof(MAGIC);
+
+        if (read_number() != VERSION) {
+            return false;
+        }
+
+        auto strings_count = read_number();
+
+        for (uint64_t it = 0; it < strings_count && !is_broken; it++) {
+            auto length = read_number();
+
+            if (length > data.size() - position) {
+                return false;
+            }
+
+            strings.emplace_back(data.substr(position, length));
+            position += length;
+        }
+
+        auto declarations_count = read_number();
+
+        for (uint64_t it = 0; it < declarations_count && !is_broken; it++) {
+            auto kind = read_byte();
+
+            if (kind > (uint8_t) DeclarationKind::TYPEALIAS) {
+                return false;
+            }
+
+            auto & name = read_string();
+
+            summary.declarations.push_back(DeclarationSummary{
+                .name = session.interner.intern(name),
+                .kind = (DeclarationKind) kind,
+                .type = read_type(0)
+            });
+
+            auto parameters_count = read_number();
+
+            for (uint64_t that = 0; that < parameters_count && !is_broken; that++) {
+                summary.declarations.back().type_parameters.push_back(session.interner.intern(read_string()));
+            }
+        }
+
+        return !is_broken && position == data.size();
+    }
+};
+
+
+bool cringe::read_interface(Session & session, const std::string & path, FileSummary & summary) {
+    threading::Span span{session.tracer, "read_interface"};
+    span.argument("path", path);
+
+    std::ifstream file{path, std::ios::binary};
+
+    if (file.fail()) {
+        return false;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    auto data = contents.str();
+
+    summary = FileSummary();
+    return InterfaceReader{.session = session, .data = data}.read(summary);
+}
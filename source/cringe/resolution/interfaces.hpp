@@ -0,0 +1,35 @@
+// Copyright (C) 2020 luna_koly
+//
+// Binary files with the global declarations
+// of a source, so that others may be compiled
+// against it without parsing it again.
+
+
+#pragma once
+
+#include <string>
+
+#include "summaries.hpp"
+
+
+namespace cringe {
+    /**
+     * Inputs with this extension are read
+     * as interfaces, not as sources.
+     */
+    inline constexpr const char * INTERFACE_EXTENSION = ".crgi";
+
+    /**
+     * Writes the summary. The same summary
+     * always gives the same bytes, so that
+     * build tools may compare them.
+     */
+    bool write_interface(Session & session, const FileSummary & summary, const std::string & path);
+
+    /**
+     * Fills the summary from the file, false if
+     * it can't be read or is not an interface.
+     * The summary refers to no file.
+     */
+    bool read_interface(Session & session, const std::string & path, FileSummary & summary);
+}
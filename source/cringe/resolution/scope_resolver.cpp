@@ -4,6 +4,7 @@
 #include "../ast/scopes.hpp"
 
 #include <stack>
+#include <initializer_list>
 #include <iostream>
 
 
@@ -11,18 +12,85 @@ using namespace cringe;
 using namespace cringe::AST;
 
 
+/**
+ * Checks if a block declares names
+ * itself, not in the nested ones.
+ */
+struct DeclarationDetector : public Visitor {
+    bool result = false;
+
+    virtual void visit(Node * it) override {}
+
+    virtual void visit(DetailedNode<NodeList> * it) override {
+        for (auto that : it->details.values) {
+            that->accept(this);
+        }
+    }
+
+    virtual void visit(DetailedNode<FunctionStatementNode> * it) override {
+        result = true;
+    }
+
+    virtual void visit(DetailedNode<ConstantDeclarationNode> * it) override {
+        result = true;
+    }
+
+    virtual void visit(DetailedNode<VariableDeclarationNode> * it) override {
+        result = true;
+    }
+
+    virtual void visit(DetailedNode<TypealiasDeclarationNode> * it) override {
+        result = true;
+    }
+};
+
+
 struct ScopeResolver : public Explorer {
+    /**
+     * The single place where all
+     * available compilation information
+     * lives.
+     */
+    Session & session;
+
     /**
      * The stack of scopes.
      */
     std::stack<Scope *> scopes;
 
+    ScopeResolver(Session & session) : session(session) {}
+
+    /**
+     * A scope for the blocks, or nullptr if they
+     * declare nothing directly, in which case
+     * they share the enclosing one.
+     */
+    Scope * create_scope(std::initializer_list<Node *> blocks) {
+        DeclarationDetector detector;
+
+        for (auto it : blocks) {
+            if (it != nullptr) {
+                it->accept(&detector);
+            }
+        }
+
+        if (!detector.result) {
+            return nullptr;
+        }
+
+        return new Scope(scopes.top());
+    }
+
+    void enter(Scope * scope) {
+        scopes.push(scope != nullptr ? scope : scopes.top());
+    }
+
     virtual void visit(Node * it) override {
         std::cout << "!!ScopeResolver wasn't implemented for `" << *it << "`!!" << std::endl;
     }
 
     virtual void visit(DetailedNode<GlobalNode> * it) override {
-        it->details.scope = Scope::create_global();
+        it->details.scope = Scope::create_global(session);
         scopes.push(it->details.scope);
 
         it->details.files->accept(this);
@@ -31,8 +99,8 @@ struct ScopeResolver : public Explorer {
     }
 
     virtual void visit(DetailedNode<FunctionStatementNode> * it) override {
-        it->details.scope = new Scope(scopes.top());
-        scopes.push(it->details.scope);
+        it->details.scope = create_scope({it->details.body});
+        enter(it->details.scope);
 
         it->details.name->accept(this);
         it->details.value_parameters->accept(this);
@@ -46,8 +114,8 @@ struct ScopeResolver : public Explorer {
     }
 
     virtual void visit(DetailedNode<IfStatementNode> * it) override {
-        it->details.scope = new Scope(scopes.top());
-        scopes.push(it->details.scope);
+        it->details.scope = create_scope({it->details.on_true, it->details.on_else});
+        enter(it->details.scope);
 
         it->details.condition->accept(this);
         it->details.on_true->accept(this);
@@ -59,9 +127,14 @@ struct ScopeResolver : public Explorer {
         scopes.pop();
     }
 
+    virtual void visit(DetailedNode<TypealiasDeclarationNode> * it) override {
+        resolve_type_parameters(it, scopes.top());
+        Explorer::visit(it);
+    }
+
     virtual void visit(DetailedNode<WhileStatementNode> * it) override {
-        it->details.scope = new Scope(scopes.top());
-        scopes.push(it->details.scope);
+        it->details.scope = create_scope({it->details.on_true});
+        enter(it->details.scope);
 
         it->details.condition->accept(this);
         it->details.on_true->accept(this);
@@ -72,6 +145,37 @@ struct ScopeResolver : public Explorer {
 
 
 void cringe::resolve_scopes(Session & session, AST::Node * node) {
-    ScopeResolver resolver;
+    threading::Span span{session.tracer, "resolve_scopes"};
+    ScopeResolver resolver{session};
     node->accept(&resolver);
 }
+
+void cringe::resolve_scopes(Session & session, AST::Node * node, AST::Scope * parent) {
+    ScopeResolver resolver{session};
+    resolver.scopes.push(parent);
+    node->accept(&resolver);
+}
+
+void cringe::resolve_type_parameters(DetailedNode<TypealiasDeclarationNode> * alias, Scope * parent) {
+    auto parameters = extract_type_parameters(alias);
+
+    if (parameters == nullptr) {
+        return;
+    }
+
+    alias->details.scope = new Scope(parent);
+
+    for (auto it : parameters->details.values) {
+        auto type = extract<TypeNode>(it);
+        auto name = type != nullptr ? extract<IdentifierNode>(type->details.identifier) : nullptr;
+        auto is_simple = type != nullptr && (type->details.subtypes == nullptr || type->details.subtypes->details.values.empty());
+
+        // the uses of a parameter
+        // resolve to its node
+        if (name != nullptr && is_simple) {
+            alias->details.scope->add(name->details.symbol, type);
+        } else {
+            std::cout << "!!ScopeResolver has no implementation for non-identifier type parameters: `" << *it << "`!!" << std::endl;
+        }
+    }
+}
@@ -7,6 +7,7 @@
 
 #include "../session.hpp"
 #include "../ast/visitor.hpp"
+#include "../ast/scopes.hpp"
 
 
 namespace cringe {
@@ -14,4 +15,14 @@ namespace cringe {
      * Substitutes scopes instead of `nullptr`s.
      */
     void resolve_scopes(Session & session, AST::Node * node);
+    /**
+     * Substitutes scopes for a subtree whose
+     * enclosing scope is `parent`.
+     */
+    void resolve_scopes(Session & session, AST::Node * node, AST::Scope * parent);
+    /**
+     * Gives a generic alias a scope of its own
+     * and declares the type parameters there.
+     */
+    void resolve_type_parameters(AST::DetailedNode<AST::TypealiasDeclarationNode> * alias, AST::Scope * parent);
 }
@@ -0,0 +1,235 @@
+#include "summaries.hpp"
+#include "scope_resolver.hpp"
+
+
+using namespace cringe;
+using namespace cringe::AST;
+
+
+/**
+ * Copies the nodes types are made of.
+ */
+struct TypeCloner : public Visitor {
+    Node * result = nullptr;
+
+    static Node * clone(Node * node) {
+        if (node == nullptr) {
+            return nullptr;
+        }
+
+        TypeCloner it;
+        node->accept(&it);
+        return it.result;
+    }
+
+    static DetailedNode<NodeList> * clone(DetailedNode<NodeList> * list) {
+        auto copy = new DetailedNode{NodeList()};
+
+        for (auto that : list->details.values) {
+            copy->details.values.push_back(clone(that));
+        }
+
+        return copy;
+    }
+
+    virtual void visit(Node * it) override {
+        result = nullptr;
+    }
+
+    virtual void visit(DetailedNode<NodeList> * it) override {
+        result = clone(it);
+    }
+
+    virtual void visit(DetailedNode<ErrorNode> * it) override {
+        result = new DetailedNode{it->details};
+    }
+
+    virtual void visit(DetailedNode<IdentifierNode> * it) override {
+        auto copy = new DetailedNode{it->details};
+        // it means nothing outside
+        // the original scope
+        copy->details.binding = Binding();
+        result = copy;
+    }
+
+    virtual void visit(DetailedNode<QualifiedAccessNode> * it) override {
+        result = new DetailedNode{QualifiedAccessNode{
+            .identifiers = clone(it->details.identifiers)
+        }};
+    }
+
+    virtual void visit(DetailedNode<BinaryExpressionNode> * it) override {
+        result = new DetailedNode{BinaryExpressionNode{
+            .left = clone(it->details.left),
+            .right = clone(it->details.right),
+            .operation = it->details.operation
+        }};
+    }
+
+    virtual void visit(DetailedNode<TypeNode> * it) override {
+        result = new DetailedNode{TypeNode{
+            .identifier = clone(it->details.identifier),
+            .subtypes = it->details.subtypes != nullptr ? clone(it->details.subtypes) : nullptr
+        }};
+    }
+};
+
+
+struct Summarizer : public Visitor {
+    FileSummary summary;
+
+    void add(Node * name, DeclarationKind kind, Node * type) {
+        auto identifier = name != nullptr ? extract<IdentifierNode>(name) : nullptr;
+
+        // the resolvers complain
+        // about these themselves
+        if (identifier != nullptr) {
+            summary.declarations.push_back(DeclarationSummary{
+                .name = identifier->details.symbol,
+                .kind = kind,
+                .type = type
+            });
+        }
+    }
+
+    virtual void visit(DetailedNode<NodeList> * it) override {
+        for (auto that : it->details.values) {
+            that->accept(this);
+        }
+    }
+
+    virtual void visit(DetailedNode<FileNode> * it) override {
+        summary.file = it->details.file;
+        it->details.root->accept(this);
+    }
+
+    virtual void visit(DetailedNode<FunctionStatementNode> * it) override {
+        add(it->details.name, DeclarationKind::FUNCTION, TypeCloner::clone(it->details.return_type));
+    }
+
+    virtual void visit(DetailedNode<ConstantDeclarationNode> * it) override {
+        auto type = TypeCloner::clone(it->details.type);
+
+        for (auto that : it->details.constants->details.values) {
+            add(that, DeclarationKind::CONSTANT, type);
+        }
+    }
+
+    virtual void visit(DetailedNode<VariableDeclarationNode> * it) override {
+        auto type = TypeCloner::clone(it->details.type);
+
+        for (auto that : it->details.variables->details.values) {
+            add(that, DeclarationKind::VARIABLE, type);
+        }
+    }
+
+    virtual void visit(DetailedNode<TypealiasDeclarationNode> * it) override {
+        auto count = summary.declarations.size();
+        add(extract_typealias_name(it), DeclarationKind::TYPEALIAS, TypeCloner::clone(it->details.value));
+
+        auto parameters = extract_type_parameters(it);
+
+        if (parameters == nullptr || summary.declarations.size() == count) {
+            return;
+        }
+
+        // the scope resolver complains
+        // about the other ones
+        for (auto that : parameters->details.values) {
+            auto type = extract<TypeNode>(that);
+            auto name = type != nullptr ? extract<IdentifierNode>(type->details.identifier) : nullptr;
+
+            if (name != nullptr) {
+                summary.declarations.back().type_parameters.push_back(name->details.symbol);
+            }
+        }
+    }
+};
+
+
+FileSummary cringe::summarize(Session & session, DetailedNode<FileNode> * file) {
+    threading::Span span{session.tracer, "summarize"};
+    Summarizer summarizer;
+    file->accept(&summarizer);
+    return std::move(summarizer.summary);
+}
+
+
+/**
+ * An identifier made up for the
+ * interned name.
+ */
+static DetailedNode<IdentifierNode> * create_name(Session & session, orders::Symbol symbol) {
+    return new DetailedNode{IdentifierNode{
+        .value = std::string(session.interner.get_text(symbol)),
+        .symbol = symbol
+    }};
+}
+
+
+/**
+ * Builds a declaration node that looks like
+ * the original one to the resolvers.
+ */
+static Node * create_stand_in(Session & session, const DeclarationSummary & declaration, Scope * scope) {
+    auto name = create_name(session, declaration.name);
+
+    switch (declaration.kind) {
+        case DeclarationKind::FUNCTION:
+            return new DetailedNode{FunctionStatementNode{
+                .name = name,
+                .return_type = declaration.type,
+                .value_parameters = new DetailedNode{NodeList()},
+                .body = new DetailedNode{NodeList()}
+            }};
+        case DeclarationKind::CONSTANT:
+            return new DetailedNode{ConstantDeclarationNode{
+                .constants = new DetailedNode{NodeList{{name}}},
+                .values = nullptr,
+                .type = declaration.type
+            }};
+        case DeclarationKind::VARIABLE:
+            return new DetailedNode{VariableDeclarationNode{
+                .variables = new DetailedNode{NodeList{{name}}},
+                .values = nullptr,
+                .type = declaration.type
+            }};
+        case DeclarationKind::TYPEALIAS: {
+            if (declaration.type_parameters.empty()) {
+                return new DetailedNode{TypealiasDeclarationNode{
+                    .type = name,
+                    .value = declaration.type
+                }};
+            }
+
+            auto parameters = new DetailedNode{NodeList()};
+
+            for (auto it : declaration.type_parameters) {
+                parameters->details.values.push_back(new DetailedNode{TypeNode{
+                    .identifier = create_name(session, it),
+                    .subtypes = new DetailedNode{NodeList()}
+                }});
+            }
+
+            auto alias = new DetailedNode{TypealiasDeclarationNode{
+                .type = new DetailedNode{TypeNode{
+                    .identifier = name,
+                    .subtypes = parameters
+                }},
+                .value = declaration.type
+            }};
+
+            resolve_type_parameters(alias, scope);
+            return alias;
+        }
+    }
+
+    return nullptr;
+}
+
+
+void cringe::declare_summary(Session & session, const FileSummary & summary, Scope * scope) {
+    for (auto & it : summary.declarations) {
+        scope->add(it.name, create_stand_in(session, it, scope));
+    }
+}
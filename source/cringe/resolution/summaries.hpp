@@ -0,0 +1,69 @@
+// Copyright (C) 2020 luna_koly
+//
+// Compact descriptions of the global
+// declarations of a file, so that other
+// files may be resolved against them
+// without keeping the file's tree.
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "../session.hpp"
+#include "../ast/nodes.hpp"
+#include "../ast/scopes.hpp"
+
+
+namespace cringe {
+    /**
+     * The sort of a global declaration.
+     */
+    enum class DeclarationKind : uint8_t {
+        FUNCTION, CONSTANT, VARIABLE, TYPEALIAS
+    };
+
+    /**
+     * Just enough of a global declaration
+     * for others to refer to it.
+     */
+    struct DeclarationSummary {
+        orders::Symbol name;
+        DeclarationKind kind;
+        /**
+         * A detached copy of the declared type,
+         * the return type of a function or the
+         * aliased type. nullptr if there's none.
+         */
+        AST::Node * type = nullptr;
+        /**
+         * The type parameters of
+         * a generic alias.
+         */
+        std::vector<orders::Symbol> type_parameters;
+    };
+
+    /**
+     * The global declarations of a file
+     * in the order they appear.
+     */
+    struct FileSummary {
+        orders::FileId file = orders::NO_FILE;
+        std::vector<DeclarationSummary> declarations;
+    };
+
+    /**
+     * Collects the global declarations. The summary
+     * shares no nodes with the tree, so call it
+     * outside of the tree's NodeRegion.
+     */
+    FileSummary summarize(Session & session, AST::DetailedNode<AST::FileNode> * file);
+
+    /**
+     * Registers stand-in declarations made up
+     * from the summary, so that names and their
+     * declared types may be resolved.
+     */
+    void declare_summary(Session & session, const FileSummary & summary, AST::Scope * scope);
+}
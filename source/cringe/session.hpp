@@ -5,13 +5,23 @@
 
 #pragma once
 
+#include <orders/util/interner.hpp>
+#include <orders/parsing/sources.hpp>
+#include <orders/parsing/diagnostic_writers.hpp>
 #include <orders/parsing/diagnostics.hpp>
 #include <orders/streams/implementations/analyzable_stream.hpp>
 
 #include <threading/thread_pool.hpp>
+#include <threading/tracer.hpp>
+
+#include "ast/instantiations.hpp"
 
 
 namespace cringe {
+    namespace AST {
+        class TypeTable;
+    }
+
     /**
      * Stores the data nessesary for
      * the whole compilation process.
@@ -33,16 +43,99 @@ namespace cringe {
              * Don't use thread pool for various stages.
              */
             const bool no_parallel = false;
+            /**
+             * Number of pool workers, 0 means
+             * as many as the process may use.
+             */
+            const int jobs = 0;
+            /**
+             * Bind each pool worker to its own CPU.
+             */
+            const bool affinity = false;
+            /**
+             * Collect and print thread pool metrics.
+             */
+            const bool pool_stats = false;
+            /**
+             * Print the interner footprint.
+             */
+            const bool interner_stats = false;
+            /**
+             * Where to write the Chrome trace,
+             * empty if tracing is off.
+             */
+            const std::string trace_out;
+            /**
+             * Stop after this many
+             * diagnostics, 0 means never.
+             */
+            const int max_errors = 0;
+            /**
+             * Don't keep all the trees at once,
+             * resolve files against summaries.
+             */
+            const bool streaming = false;
+            /**
+             * `text`, `jsonl` or `sarif`.
+             */
+            const std::string diagnostics_format = "text";
+            /**
+             * Where machine-readable diagnostics
+             * go, empty means stderr.
+             */
+            const std::string diagnostics_out;
+            /**
+             * Where to write the interfaces of
+             * the sources, empty if nowhere.
+             */
+            const std::string interfaces_out;
+            /**
+             * Print the types the resolvers
+             * have found for the nodes.
+             */
+            const bool print_types = false;
         } options;
 
         /**
          * Collects diagnostics.
          */
         orders::DiagnosticReporter reporter;
+        /**
+         * Texts of the input files
+         * the diagnostics refer to.
+         */
+        orders::SourceManager sources;
+        /**
+         * Identifiers of all the files,
+         * safe to use from any thread.
+         */
+        orders::Interner interner;
+        /**
+         * Every instantiated type whose parts are
+         * declared globally exists only once.
+         */
+        AST::InstantiationCache instantiations;
         /**
          * If parallel compilation is allowed,
          * this is where the pool lives.
          */
         threading::ThreadPool * pool = nullptr;
+        /**
+         * If tracing is enabled, this is where
+         * the spans go.
+         */
+        threading::Tracer * tracer = nullptr;
+        /**
+         * If diagnostics are written in a
+         * machine-readable format, they go
+         * through this one per file.
+         */
+        orders::DiagnosticStream * diagnostic_stream = nullptr;
+        /**
+         * If the types of the nodes are needed
+         * after the resolution, the deep resolver
+         * records them here.
+         */
+        AST::TypeTable * types = nullptr;
     };
 }
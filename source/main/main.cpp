@@ -1,14 +1,24 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <map>
+#include <unordered_map>
+#include <memory>
 #include <filesystem>
 
 #include <arrrgh/arrrgh.hpp>
 
 #include <orders/streams/implementations/std_stream.hpp>
+#include <orders/parsing/diagnostic_writers.hpp>
 
 #include <cringe/about.hpp>
+#include <cringe/pipeline.hpp>
+#include <cringe/ast/explorer.hpp>
+#include <cringe/ast/type_table.hpp>
 #include <cringe/parsing/parser.hpp>
+#include <cringe/resolution/summaries.hpp>
+#include <cringe/resolution/interfaces.hpp>
 #include <cringe/resolution/scope_resolver.hpp>
 #include <cringe/resolution/global_declaration_resolver.hpp>
 #include <cringe/resolution/deep_declaration_resolver.hpp>
@@ -16,49 +26,368 @@
 #include <threading/thread_pool.hpp>
 
 
-void visualize_scope(cringe::AST::Scope * scope, const std::string & indent = "--") {
+void visualize_scope(cringe::Session & session, cringe::AST::Scope * scope, const std::string & indent = "--") {
+    // symbols are unordered, sort by name
+    std::map<std::string_view, cringe::AST::Node *> sorted;
+
     for (auto that : scope->get_declarations()) {
+        sorted[session.interner.get_text(that.first)] = that.second;
+    }
+
+    for (auto that : sorted) {
         std::cout << indent << ' ' << that.first << " := " << *that.second << std::endl;
         auto scope = extract_scope(that.second);
 
         if (scope != nullptr) {
-            visualize_scope(scope, indent + "--");
+            visualize_scope(session, scope, indent + "--");
+        }
+    }
+}
+
+
+/**
+ * Prints the expressions that have
+ * types in the order they appear.
+ */
+struct TypesVisualizer : public cringe::AST::Explorer {
+    cringe::AST::TypeTable & types;
+    std::ostream & output;
+    /**
+     * Shared instantiations numbered in the order
+     * they're met, equal numbers mean one node.
+     */
+    std::unordered_map<cringe::AST::Node *, size_t> shared;
+
+    TypesVisualizer(cringe::AST::TypeTable & types, std::ostream & output) : types(types), output(output) {}
+
+    void show(cringe::AST::Node * node) {
+        auto type = types.get(node);
+
+        if (type == nullptr) {
+            return;
+        }
+
+        output << "-- " << *node << " : " << *type;
+
+        if (type->details.is_shared) {
+            auto index = shared.emplace(type, shared.size() + 1).first->second;
+            output << " (shared #" << index << ")";
+        }
+
+        output << std::endl;
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::BinaryExpressionNode> * it) override {
+        show(it);
+        Explorer::visit(it);
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::UnaryExpressionNode> * it) override {
+        show(it);
+        Explorer::visit(it);
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::QualifiedAccessNode> * it) override {
+        show(it);
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::CharacterLiteralNode> * it) override {
+        show(it);
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::IdentifierNode> * it) override {
+        show(it);
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::NumberLiteralNode> * it) override {
+        show(it);
+    }
+
+    virtual void visit(cringe::AST::DetailedNode<cringe::AST::StringLiteralNode> * it) override {
+        show(it);
+    }
+};
+
+
+void visualize_pool_metrics(const threading::ThreadPool::Metrics & metrics) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    std::cout << "Scheduled > " << metrics.tasks_scheduled << " tasks, " << metrics.tasks_run_in_place << " run in place" << std::endl;
+    std::cout << "Queue > max depth " << metrics.max_queue_depth;
+    std::cout << ", total wait " << duration_cast<microseconds>(metrics.total_queue_time).count() << "us";
+    std::cout << ", max wait " << duration_cast<microseconds>(metrics.max_queue_time).count() << "us" << std::endl;
+
+    for (size_t it = 0; it < metrics.workers.size(); it++) {
+        auto & worker = metrics.workers[it];
+
+        std::cout << "Worker #" << it << " > " << worker.tasks_executed << " tasks";
+        std::cout << ", busy " << duration_cast<microseconds>(worker.busy_time).count() << "us";
+        std::cout << ", idle " << duration_cast<microseconds>(worker.idle_time).count() << "us";
+        std::cout << ", " << worker.wake_ups << " wake-ups" << std::endl;
+    }
+}
+
+
+std::unique_ptr<orders::DiagnosticWriter> create_diagnostic_writer(const std::string & format, std::ostream & output) {
+    if (format == "jsonl") {
+        return std::make_unique<orders::JsonLinesWriter>(output);
+    }
+
+    auto version = std::to_string(__CRINGE_VERSION_MAJOR__) + '.' + std::to_string(__CRINGE_VERSION_MINOR__);
+    return std::make_unique<orders::SarifWriter>(output, "cringe", version);
+}
+
+
+/**
+ * The deepest directory all the
+ * sources are located in.
+ */
+std::filesystem::path get_sources_root(const std::vector<std::string> & filenames) {
+    if (filenames.empty()) {
+        return {};
+    }
+
+    auto root = std::filesystem::path(filenames.front()).lexically_normal().parent_path();
+
+    for (auto & it : filenames) {
+        auto directory = std::filesystem::path(it).lexically_normal().parent_path();
+        std::filesystem::path common;
+        auto left = root.begin();
+        auto right = directory.begin();
+
+        while (left != root.end() && right != directory.end() && *left == *right) {
+            common /= *left;
+            ++left;
+            ++right;
+        }
+
+        root = common;
+    }
+
+    return root;
+}
+
+
+/**
+ * Sources with the same name in different
+ * directories keep apart, the interfaces
+ * mirror their paths from `sources_root`.
+ */
+void emit_interface(cringe::Session & session, const std::filesystem::path & sources_root, const cringe::FileSummary & summary) {
+    auto source = std::filesystem::path(session.sources.get_filename(summary.file)).lexically_normal();
+    auto relative = source.lexically_relative(sources_root);
+    auto path = std::filesystem::path(session.options.interfaces_out) / (relative.string() + cringe::INTERFACE_EXTENSION);
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    if (!cringe::write_interface(session, summary, path.string())) {
+        std::cout << "Error > Couldn't write the interface to `" << path.string() << '`' << std::endl;
+    }
+}
+
+
+void run_whole_std_1(cringe::Session & session, const std::vector<std::string> & filenames, const std::vector<cringe::FileSummary> & dependencies) {
+    auto sources_root = get_sources_root(filenames);
+    cringe::AST::DetailedNode<cringe::AST::GlobalNode> * global = nullptr;
+
+    {
+        // parsing and scope building are
+        // chained per file, no barrier between
+        threading::Span span{session.tracer, "process_files"};
+        span.argument("files", (int64_t) filenames.size());
+        global = cringe::process_files(session, filenames);
+    }
+
+    {
+        threading::Span span{session.tracer, "print_raw_ast"};
+        std::cout << "==== Raw AST ====" << std::endl;
+        std::cout << *global << std::endl;
+        std::cout << std::endl;
+    }
+
+    // resolving a broken AST would only
+    // produce more of the same errors
+    if (!session.reporter.is_limit_reached()) {
+        // the sources may redeclare
+        // what the interfaces have
+        for (auto & it : dependencies) {
+            cringe::declare_summary(session, it, global->details.scope);
+        }
+
+        cringe::resolve_global_declarations(session, global);
+        cringe::resolve_deep_declarations(session, global);
+
+        if (!session.options.interfaces_out.empty()) {
+            threading::Span span{session.tracer, "emit_interfaces"};
+
+            for (auto it : global->details.files->details.values) {
+                emit_interface(session, sources_root, cringe::summarize(session, cringe::AST::extract<cringe::AST::FileNode>(it)));
+            }
+        }
+
+        {
+            threading::Span span{session.tracer, "print_resolved_ast"};
+            std::cout << "==== Resolved AST ====" << std::endl;
+            std::cout << *global << std::endl;
+            std::cout << std::endl;
+        }
+
+        if (session.types != nullptr) {
+            threading::Span span{session.tracer, "print_types"};
+            std::cout << "==== Types ====" << std::endl;
+            TypesVisualizer visualizer{*session.types, std::cout};
+            global->accept(&visualizer);
+            std::cout << std::endl;
+        }
+
+        {
+            threading::Span span{session.tracer, "print_global_declarations"};
+            std::cout << "==== Global declarations ====" << std::endl;
+            visualize_scope(session, global->details.scope);
+            std::cout << std::endl;
         }
     }
 }
 
 
 int run_std_1(cringe::Session & session) {
+    threading::Span run_span{session.tracer, "run_std_1"};
     std::vector<std::string> filenames;
 
+    std::vector<cringe::FileSummary> dependencies;
+
     for (size_t that = 1; that < arrrgh::parameters.size(); that++) {
-        auto filename = std::filesystem::absolute(arrrgh::parameters[that]).string();
-        filenames.push_back(filename);
+        auto filename = std::filesystem::absolute(arrrgh::parameters[that]);
+
+        if (filename.extension() != cringe::INTERFACE_EXTENSION) {
+            filenames.push_back(filename.string());
+            continue;
+        }
+
+        // interfaces only bring declarations,
+        // their sources are never parsed
+        cringe::FileSummary summary;
+
+        if (!cringe::read_interface(session, filename.string(), summary)) {
+            std::cout << "Error > Couldn't read the interface `" << filename.string() << '`' << std::endl;
+            return 1;
+        }
+
+        dependencies.push_back(std::move(summary));
+    }
+
+    std::ofstream diagnostics_file;
+    std::unique_ptr<orders::DiagnosticWriter> writer;
+    std::unique_ptr<orders::DiagnosticStream> stream;
+
+    if (session.options.diagnostics_format != "text") {
+        std::ostream * output = &std::cerr;
+
+        if (!session.options.diagnostics_out.empty()) {
+            diagnostics_file.open(session.options.diagnostics_out);
+
+            if (diagnostics_file.fail()) {
+                std::cout << "Error > Couldn't open `" << session.options.diagnostics_out << "` for diagnostics" << std::endl;
+                return 1;
+            }
+
+            output = &diagnostics_file;
+        }
+
+        // diagnostics of each file go out right
+        // after it's parsed, not at the very end
+        writer = create_diagnostic_writer(session.options.diagnostics_format, *output);
+        stream = std::make_unique<orders::DiagnosticStream>(session.reporter, session.sources, *writer, filenames.size());
+        session.diagnostic_stream = stream.get();
     }
 
-    auto global = cringe::parse_files(session, filenames);
+    if (session.options.streaming) {
+        threading::Span span{session.tracer, "process_files_streaming"};
+        span.argument("files", (int64_t) filenames.size());
+        auto sources_root = get_sources_root(filenames);
+        bool is_first = true;
+        // the trees are gone by the
+        // time the section is printed
+        std::stringstream types;
+
+        // trees are freed right after being
+        // printed, so there's no raw AST
+        auto global_scope = cringe::process_files_streaming(session, filenames, dependencies, [&](auto file, auto & summary) {
+            if (is_first) {
+                std::cout << "==== Resolved AST ====" << std::endl;
+                is_first = false;
+            }
+
+            std::cout << *file << std::endl;
+
+            if (session.types != nullptr) {
+                TypesVisualizer visualizer{*session.types, types};
+                file->accept(&visualizer);
+            }
+
+            if (!session.options.interfaces_out.empty()) {
+                emit_interface(session, sources_root, summary);
+            }
+        });
+
+        if (!is_first) {
+            std::cout << std::endl;
+        }
 
-    std::cout << "==== Raw AST ====" << std::endl;
-    std::cout << *global << std::endl;
-    std::cout << std::endl;
+        if (session.types != nullptr && !is_first) {
+            std::cout << "==== Types ====" << std::endl;
+            std::cout << types.str() << std::endl;
+        }
 
-    cringe::resolve_scopes(session, global);
-    cringe::resolve_global_declarations(session, global);
-    cringe::resolve_deep_declarations(session, global);
+        if (!session.reporter.is_limit_reached()) {
+            threading::Span span{session.tracer, "print_global_declarations"};
+            std::cout << "==== Global declarations ====" << std::endl;
+            visualize_scope(session, global_scope);
+            std::cout << std::endl;
+        }
+    } else {
+        run_whole_std_1(session, filenames, dependencies);
+    }
 
-    std::cout << "==== Resolved AST ====" << std::endl;
-    std::cout << *global << std::endl;
-    std::cout << std::endl;
+    if (stream != nullptr) {
+        // the resolvers' diagnostics
+        // are only known by now
+        stream->finish();
+        session.diagnostic_stream = nullptr;
+    }
 
-    std::cout << "==== Global declarations ====" << std::endl;
-    visualize_scope(global->details.scope);
-    std::cout << std::endl;
+    {
+        threading::Span span{session.tracer, "print_diagnostics"};
+        std::cout << "==== Diagnostics ====" << std::endl;
+        if (stream == nullptr) {
+            for (auto that : session.reporter.diagnostics) {
+                session.sources.render(std::cout, that->get_file(), that->get_range());
+                std::cout << *that << std::endl;
+            }
+        }
+        if (session.reporter.is_limit_reached()) {
+            std::cout << "Error > Stopped after " << session.reporter.limit << " errors";
+            std::cout << ", " << session.reporter.dropped_count << " more dropped." << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    if (session.pool != nullptr && session.pool->is_collecting_metrics()) {
+        session.pool->wait();
+
+        std::cout << "==== Thread pool ====" << std::endl;
+        visualize_pool_metrics(session.pool->get_metrics());
+        std::cout << std::endl;
+    }
 
-    std::cout << "==== Diagnostics ====" << std::endl;
-    for (auto that : session.reporter.diagnostics) {
-        std::cout << *that << std::endl;
+    if (session.options.interner_stats) {
+        std::cout << "==== Interner ====" << std::endl;
+        std::cout << "Symbols > " << session.interner.get_symbols_count() << std::endl;
+        std::cout << "Memory > " << session.interner.get_memory_usage() << " bytes" << std::endl;
+        std::cout << std::endl;
     }
-    std::cout << std::endl;
 
     std::cout << "==== Done ====" << std::endl;
     return 0;
@@ -76,16 +405,56 @@ int run() {
         .options = {
             .std = std::string(std),
             .tab_size = arrrgh::options<int>["tab-size"],
-            .no_parallel = arrrgh::options<bool>["no-parallel"]
+            .no_parallel = arrrgh::options<bool>["no-parallel"],
+            .jobs = arrrgh::options<int>["jobs"],
+            .affinity = arrrgh::options<bool>["affinity"],
+            .pool_stats = arrrgh::options<bool>["pool-stats"],
+            .interner_stats = arrrgh::options<bool>["interner-stats"],
+            .trace_out = std::string(arrrgh::options<arrrgh::StringLike>["trace-out"]),
+            .max_errors = arrrgh::options<int>["max-errors"],
+            .streaming = arrrgh::options<bool>["streaming"],
+            .diagnostics_format = std::string(arrrgh::options<arrrgh::StringLike>["diagnostics-format"]),
+            .diagnostics_out = std::string(arrrgh::options<arrrgh::StringLike>["diagnostics-out"]),
+            .interfaces_out = std::string(arrrgh::options<arrrgh::StringLike>["interfaces-out"]),
+            .print_types = arrrgh::options<bool>["print-types"]
         }
     };
 
+    session.reporter.limit = (size_t) session.options.max_errors;
+
     if (session.options.no_parallel == false) {
-        session.pool = new threading::ThreadPool();
+        auto jobs = session.options.jobs;
+
+        if (jobs == 0) {
+            jobs = threading::get_available_concurrency();
+        }
+
+        session.pool = new threading::ThreadPool(jobs, session.options.affinity, session.options.pool_stats);
+    }
+
+    if (!session.options.trace_out.empty()) {
+        session.tracer = new threading::Tracer();
+    }
+
+    if (session.options.print_types) {
+        session.types = new cringe::AST::TypeTable();
     }
 
     if (session.options.std == "1") {
-        return run_std_1(session);
+        auto result = run_std_1(session);
+
+        if (session.tracer != nullptr) {
+            if (session.pool != nullptr) {
+                // helper tasks may still be finishing
+                session.pool->wait();
+            }
+
+            if (!session.tracer->write(session.options.trace_out)) {
+                std::cout << "Error > Couldn't write the trace to `" << session.options.trace_out << '`' << std::endl;
+            }
+        }
+
+        return result;
     }
 
     std::cout << "Error > Unsupported language version > `" << arrrgh::options<arrrgh::StringLike>["std"] << '`' << std::endl;
@@ -99,6 +468,35 @@ static const char * HELP_TEXT =
     "        Specifies the language version.\n"
     "    --no-parallel\n"
     "        Disables parallel compilation.\n"
+    "    -j, --jobs <int>\n"
+    "        Sets the number of pool workers, 0 means as many\n"
+    "        as the process may use.\n"
+    "    --affinity\n"
+    "        Binds each pool worker to its own CPU.\n"
+    "    --pool-stats\n"
+    "        Prints the thread pool metrics.\n"
+    "    --trace-out <file>\n"
+    "        Writes a Chrome trace of the compilation stages there.\n"
+    "    --interner-stats\n"
+    "        Prints the number of identifiers and their memory.\n"
+    "    --max-errors <int>\n"
+    "        Stops after this many diagnostics, 0 means no limit.\n"
+    "    --streaming\n"
+    "        Keeps only a few syntax trees in memory at a time.\n"
+    "        The texts of all the files are still kept, they're\n"
+    "        parsed again for resolution and shown in diagnostics.\n"
+    "    --diagnostics-format [text | jsonl | sarif]\n"
+    "        Writes diagnostics as JSON Lines or SARIF as soon\n"
+    "        as each file is processed.\n"
+    "    --diagnostics-out <file>\n"
+    "        Where machine-readable diagnostics go, stderr by default.\n"
+    "    --interfaces-out <directory>\n"
+    "        Writes `<source path>.crgi` interfaces of the sources there,\n"
+    "        the paths are relative to the directory of all the sources.\n"
+    "        Interfaces given instead of sources are used for\n"
+    "        their declarations without parsing the sources.\n"
+    "    --print-types\n"
+    "        Prints the types found for the expressions.\n"
     "    -t, --tab-size <int>\n"
     "        Sets the tab size for the lexer.\n"
     "    -v, --version\n"
@@ -114,10 +512,22 @@ int main(int argc, char * argv[]) {
     arrrgh::add_integer("tab-size", 4);
     arrrgh::add_option<arrrgh::StringLike>("std", "undefined");
     arrrgh::add_flag("no-parallel");
+    arrrgh::add_integer("jobs", 0);
+    arrrgh::add_flag("affinity");
+    arrrgh::add_flag("pool-stats");
+    arrrgh::add_flag("interner-stats");
+    arrrgh::add_option<arrrgh::StringLike>("trace-out", "");
+    arrrgh::add_integer("max-errors", 0);
+    arrrgh::add_flag("streaming");
+    arrrgh::add_option<arrrgh::StringLike>("diagnostics-format", "text");
+    arrrgh::add_option<arrrgh::StringLike>("diagnostics-out", "");
+    arrrgh::add_option<arrrgh::StringLike>("interfaces-out", "");
+    arrrgh::add_flag("print-types");
 
     arrrgh::add_alias('h', "help");
     arrrgh::add_alias('v', "version");
     arrrgh::add_alias('t', "tab-size");
+    arrrgh::add_alias('j', "jobs");
 
     arrrgh::parse(argv, argv + argc);
 
@@ -138,6 +548,22 @@ int main(int argc, char * argv[]) {
         std::cout << "Wait > Tab size `" << arrrgh::options<int>["tab-size"] << "` is invalid. It must be > 1";
     }
 
+    else if (arrrgh::options<int>["jobs"] < 0) {
+        std::cout << "Wait > Jobs count `" << arrrgh::options<int>["jobs"] << "` is invalid. It must be >= 0";
+    }
+
+    else if (arrrgh::options<int>["max-errors"] < 0) {
+        std::cout << "Wait > Errors limit `" << arrrgh::options<int>["max-errors"] << "` is invalid. It must be >= 0";
+    }
+
+    else if (
+        arrrgh::options<arrrgh::StringLike>["diagnostics-format"] != "text" &&
+        arrrgh::options<arrrgh::StringLike>["diagnostics-format"] != "jsonl" &&
+        arrrgh::options<arrrgh::StringLike>["diagnostics-format"] != "sarif"
+    ) {
+        std::cout << "Wait > Diagnostics format `" << arrrgh::options<arrrgh::StringLike>["diagnostics-format"] << "` is invalid. It must be `text`, `jsonl` or `sarif`";
+    }
+
     else {
         return run();
     }
@@ -0,0 +1,245 @@
+#include "diagnostic_writers.hpp"
+
+#include <cctype>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+
+
+static void write_json_string(std::ostream & output, std::string_view text) {
+    output << '"';
+
+    for (char it : text) {
+        switch (it) {
+            case '"':
+                output << "\\\"";
+                break;
+            case '\\':
+                output << "\\\\";
+                break;
+            case '\n':
+                output << "\\n";
+                break;
+            case '\r':
+                output << "\\r";
+                break;
+            case '\t':
+                output << "\\t";
+                break;
+            default:
+                if ((unsigned char) it < 0x20) {
+                    // formatted locally so that the fill
+                    // doesn't stick to the caller's stream
+                    char escape[8];
+                    std::snprintf(escape, sizeof escape, "\\u%04x", (unsigned char) it);
+                    output << escape;
+                } else {
+                    output << it;
+                }
+        }
+    }
+
+    output << '"';
+}
+
+/**
+ * The printed diagnostic without
+ * the human-oriented prefix.
+ */
+static std::string get_message(orders::Diagnostic & diagnostic) {
+    std::stringstream rendered;
+    diagnostic.print(rendered);
+
+    auto result = rendered.str();
+    const std::string prefix = "Error > ";
+
+    if (result.compare(0, prefix.size(), prefix) == 0) {
+        result.erase(0, prefix.size());
+    }
+
+    return result;
+}
+
+
+/**
+ * SARIF locations are URIs, so everything
+ * but the unreserved characters and the
+ * separators is percent-encoded.
+ */
+static std::string get_file_uri(const std::string & filename) {
+    std::error_code error;
+    auto path = std::filesystem::absolute(filename, error);
+    auto text = (error ? std::filesystem::path(filename) : path).generic_string();
+
+    // `C:/...` becomes `file:///C:/...`
+    std::string result = text.empty() || text.front() != '/' ? "file:///" : "file://";
+
+    for (unsigned char it : text) {
+        if (std::isalnum(it) || it == '-' || it == '.' || it == '_' || it == '~' || it == '/' || it == ':') {
+            result += (char) it;
+        } else {
+            const char * digits = "0123456789ABCDEF";
+            result += '%';
+            result += digits[it >> 4];
+            result += digits[it & 15];
+        }
+    }
+
+    return result;
+}
+
+
+orders::JsonLinesWriter::JsonLinesWriter(std::ostream & output) : output(output) {}
+
+void orders::JsonLinesWriter::write(const SourceManager & sources, Diagnostic & diagnostic) {
+    auto file = diagnostic.get_file();
+
+    output << "{\"severity\":\"error\",\"message\":";
+    write_json_string(output, get_message(diagnostic));
+
+    if (file != NO_FILE) {
+        output << ",\"file\":";
+        write_json_string(output, sources.get_filename(file));
+    }
+
+    if (file != NO_FILE && !diagnostic.get_range().is_none()) {
+        auto range = diagnostic.get_range();
+        auto start = sources.locate(file, range.start);
+        auto stop = sources.locate(file, range.stop);
+
+        output << ",\"line\":" << start.line << ",\"column\":" << start.column;
+        output << ",\"end_line\":" << stop.line << ",\"end_column\":" << stop.column;
+        output << ",\"offset\":" << range.start << ",\"length\":" << range.stop - range.start;
+    }
+
+    // flushing lets tools see each
+    // line right away
+    output << '}' << std::endl;
+}
+
+
+orders::SarifWriter::SarifWriter(std::ostream & output, const std::string & tool_name, const std::string & tool_version)
+    : output(output) {
+    output << "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",\"version\":\"2.1.0\",";
+    output << "\"runs\":[{\"tool\":{\"driver\":{\"name\":";
+    write_json_string(output, tool_name);
+    output << ",\"version\":";
+    write_json_string(output, tool_version);
+    output << "}},\"results\":[" << std::endl;
+}
+
+void orders::SarifWriter::write(const SourceManager & sources, Diagnostic & diagnostic) {
+    auto file = diagnostic.get_file();
+
+    if (!is_first) {
+        output << ',' << '\n';
+    }
+
+    is_first = false;
+
+    output << "{\"level\":\"error\",\"message\":{\"text\":";
+    write_json_string(output, get_message(diagnostic));
+    output << '}';
+
+    if (file != NO_FILE) {
+        auto range = diagnostic.get_range();
+
+        output << ",\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+        write_json_string(output, get_file_uri(sources.get_filename(file)));
+        output << '}';
+
+        if (!range.is_none()) {
+            auto start = sources.locate(file, range.start);
+            auto stop = sources.locate(file, range.stop);
+
+            output << ",\"region\":{";
+            output << "\"startLine\":" << start.line << ",\"startColumn\":" << start.column;
+            output << ",\"endLine\":" << stop.line << ",\"endColumn\":" << stop.column;
+            output << ",\"charOffset\":" << range.start << ",\"charLength\":" << range.stop - range.start;
+            output << '}';
+        }
+
+        output << "}}]";
+    }
+
+    output << '}' << std::flush;
+}
+
+void orders::SarifWriter::finish() {
+    output << '\n' << "]}]}" << std::endl;
+}
+
+
+orders::DiagnosticStream::DiagnosticStream(DiagnosticReporter & reporter, const SourceManager & sources, DiagnosticWriter & writer, size_t files_count)
+    : reporter(reporter), sources(sources), writer(writer), completed(files_count, NO_FILE), is_completed(files_count, false) {}
+
+void orders::DiagnosticStream::collect() {
+    std::lock_guard lock(reporter.diagnostics_protector);
+
+    for (; cursor < reporter.diagnostics.size(); cursor++) {
+        auto it = reporter.diagnostics[cursor];
+        pending[it->get_file()].push_back(it);
+    }
+}
+
+void orders::DiagnosticStream::write_file(FileId file) {
+    auto found = pending.find(file);
+
+    if (found == pending.end()) {
+        return;
+    }
+
+    for (auto it : found->second) {
+        writer.write(sources, *it);
+    }
+
+    pending.erase(found);
+}
+
+void orders::DiagnosticStream::complete(size_t index, FileId file) {
+    std::lock_guard lock(protector);
+    collect();
+
+    completed[index] = file;
+    is_completed[index] = true;
+
+    for (; next < completed.size() && is_completed[next]; next++) {
+        if (completed[next] != NO_FILE) {
+            write_file(completed[next]);
+        }
+    }
+}
+
+void orders::DiagnosticStream::finish() {
+    std::lock_guard lock(protector);
+    collect();
+
+    // besides the files that haven't been completed,
+    // e.g. skipped after the errors limit, later stages
+    // report more about the ones written already
+    for (auto it : completed) {
+        if (it != NO_FILE) {
+            write_file(it);
+        }
+    }
+
+    next = completed.size();
+    write_file(NO_FILE);
+
+    // nothing should be left, but
+    // keep it in some fixed order
+    std::vector<FileId> rest;
+
+    for (auto & it : pending) {
+        rest.push_back(it.first);
+    }
+
+    std::sort(rest.begin(), rest.end());
+
+    for (auto it : rest) {
+        write_file(it);
+    }
+
+    writer.finish();
+}
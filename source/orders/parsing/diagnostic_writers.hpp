@@ -0,0 +1,127 @@
+// Copyright (C) 2020 luna_koly
+//
+// Machine-readable diagnostics output.
+// Each diagnostic is written as soon as it's
+// passed, so tools don't have to wait for
+// the whole compilation.
+
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+#include "sources.hpp"
+#include "diagnostics.hpp"
+
+
+namespace orders {
+    /**
+     * Writes diagnostics one by one.
+     */
+    struct DiagnosticWriter {
+        virtual ~DiagnosticWriter() {}
+
+        virtual void write(const SourceManager & sources, Diagnostic & diagnostic) = 0;
+
+        /**
+         * Closes whatever has been opened.
+         * Nothing may be written afterwards.
+         */
+        virtual void finish() {}
+    };
+
+    /**
+     * One JSON object per line.
+     */
+    class JsonLinesWriter : public DiagnosticWriter {
+    public:
+        JsonLinesWriter(std::ostream & output);
+
+        virtual void write(const SourceManager & sources, Diagnostic & diagnostic) override;
+
+    private:
+        std::ostream & output;
+    };
+
+    /**
+     * A single SARIF 2.1.0 log whose
+     * `results` array grows as diagnostics
+     * come in.
+     */
+    class SarifWriter : public DiagnosticWriter {
+    public:
+        SarifWriter(std::ostream & output, const std::string & tool_name, const std::string & tool_version);
+
+        virtual void write(const SourceManager & sources, Diagnostic & diagnostic) override;
+
+        virtual void finish() override;
+
+    private:
+        std::ostream & output;
+        bool is_first = true;
+    };
+
+    /**
+     * Passes the reported diagnostics to the
+     * writer file by file. Files may complete
+     * in any order, but their diagnostics are
+     * written in the order of the files.
+     */
+    class DiagnosticStream {
+    public:
+        /**
+         * `files_count` is the number of
+         * `complete()` calls to expect.
+         */
+        DiagnosticStream(DiagnosticReporter & reporter, const SourceManager & sources, DiagnosticWriter & writer, size_t files_count);
+
+        /**
+         * Marks the `index`-th file as done. Its
+         * diagnostics are written once all the
+         * preceding files are done too. NO_FILE
+         * is for files that couldn't be read.
+         */
+        void complete(size_t index, FileId file);
+
+        /**
+         * Writes everything left in the order
+         * of the files, then the diagnostics
+         * that don't refer to any file, and
+         * finishes the writer.
+         */
+        void finish();
+
+    private:
+        DiagnosticReporter & reporter;
+        const SourceManager & sources;
+        DiagnosticWriter & writer;
+
+        /**
+         * Reporter diagnostics before this
+         * one are already sorted by file.
+         */
+        size_t cursor = 0;
+        std::unordered_map<FileId, std::vector<Diagnostic *>> pending;
+
+        /**
+         * The file of each completed index,
+         * `next` is the first one not written.
+         */
+        std::vector<FileId> completed;
+        std::vector<bool> is_completed;
+        size_t next = 0;
+
+        std::mutex protector;
+
+        /**
+         * Moves the newly reported diagnostics
+         * into `pending`.
+         */
+        void collect();
+
+        void write_file(FileId file);
+    };
+}
@@ -11,39 +11,41 @@
 #include <string>
 #include <iostream>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
 
 #include "../util/printable.hpp"
 
 #define __DIAGNOSTIC__                                      \
     /**                                                     \
-     * Full path to the input file.                         \
+     * The file the error was found in,                     \
+     * NO_FILE if it's unknown.                             \
      */                                                     \
-    std::string filename;                                   \
+    orders::FileId file = orders::NO_FILE;                  \
     /**                                                     \
-     * The line the error was found at.                     \
+     * Some place, NO_RANGE if only the                     \
+     * file is known. The text around it                    \
+     * is looked up only when printing.                     \
      */                                                     \
-    size_t line_number;                                     \
-    /**                                                     \
-     * Some place.                                          \
-     */                                                     \
-    orders::Range range;                                    \
-    /**                                                     \
-     * Well, maybe range is fine enough                     \
-     * and we could run through the file once               \
-     * more to grab parts of text described by it,          \
-     * but because there's no such an infrastructure for    \
-     * now, I'll go with this approach.                     \
-     */                                                     \
-    std::string visualization;
+    orders::Range range = orders::NO_RANGE;
 
-#define __DIAGNOSTIC_HEADER__                                                                 \
-    output                                                                                    \
-        << details.visualization << '\n'                                                      \
-        << "Quick Link > " << details.filename << "(" << details.line_number << ",1)" << '\n' \
-        << "Error > "
+#define __DIAGNOSTIC_HEADER__ \
+    output << "Error > "
 
 
 namespace orders {
+    /**
+     * Refers to a file registered
+     * in a SourceManager.
+     */
+    using FileId = uint32_t;
+
+    /**
+     * For diagnostics that don't
+     * know where they come from.
+     */
+    inline constexpr FileId NO_FILE = 0xFFFFFFFF;
+
     /**
      * A part of the input source
      * code.
@@ -51,8 +53,18 @@ namespace orders {
     struct Range {
         size_t start;
         size_t stop;
+
+        bool is_none() const {
+            return start == SIZE_MAX;
+        }
     };
 
+    /**
+     * For diagnostics that know the file,
+     * but not the place within it.
+     */
+    inline constexpr Range NO_RANGE = {SIZE_MAX, SIZE_MAX};
+
     /**
      * Represents a diagnostic reported
      * by lexer/parser/etc.
@@ -63,10 +75,10 @@ namespace orders {
         virtual ~Diagnostic() {}
 
         /**
-         * Returns the line the diagnostic was
-         * reported at.
+         * Returns the file the diagnostic
+         * was reported in.
          */
-        virtual size_t get_line_number() = 0;
+        virtual FileId get_file() = 0;
 
         /**
          * Returns the character range the
@@ -93,8 +105,8 @@ namespace orders {
 
         DetailedDiagnostic(T && details) : details(details) {}
 
-        virtual size_t get_line_number() override {
-            return details.line_number;
+        virtual FileId get_file() override {
+            return details.file;
         }
 
         virtual Range get_range() override {
@@ -115,6 +127,22 @@ namespace orders {
          * Allows concurrency.
          */
         std::mutex diagnostics_protector;
+        /**
+         * Diagnostics beyond this number are
+         * dropped, 0 means no limit. Set it
+         * before reporting anything.
+         */
+        size_t limit = 0;
+        /**
+         * Number of diagnostics that
+         * didn't fit into the limit.
+         */
+        size_t dropped_count = 0;
+        /**
+         * Lets others check the limit
+         * without taking the lock.
+         */
+        std::atomic<bool> is_full = false;
 
         /**
          * Adds the diagnostic to the inner
@@ -123,8 +151,48 @@ namespace orders {
         template <typename D>
         void report(D && diagnostic) {
             std::lock_guard lock(diagnostics_protector);
+
+            if (limit != 0 && diagnostics.size() >= limit) {
+                dropped_count += 1;
+                return;
+            }
+
             auto it = new DetailedDiagnostic<D>{std::move(diagnostic)};
             diagnostics.push_back(it);
+
+            if (limit != 0 && diagnostics.size() >= limit) {
+                is_full.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Adds a diagnostic that has been held
+         * back elsewhere to keep the order, and
+         * takes the ownership of it.
+         */
+        void add(Diagnostic * diagnostic) {
+            std::lock_guard lock(diagnostics_protector);
+
+            if (limit != 0 && diagnostics.size() >= limit) {
+                dropped_count += 1;
+                delete diagnostic;
+                return;
+            }
+
+            diagnostics.push_back(diagnostic);
+
+            if (limit != 0 && diagnostics.size() >= limit) {
+                is_full.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * True once the limit has been
+         * reached, so there's no point
+         * in looking for more errors.
+         */
+        bool is_limit_reached() const {
+            return is_full.load(std::memory_order_relaxed);
         }
 
         /**
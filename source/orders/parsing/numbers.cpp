@@ -0,0 +1,377 @@
+#include "numbers.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// the SWAR tricks below expect the first
+// character in the lowest byte
+#if defined(_MSC_VER) || defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    #define __ORDERS_LITTLE_ENDIAN__
+#endif
+
+
+static const uint64_t ONES = 0x0101010101010101;
+static const uint64_t HIGH_BITS = 0x8080808080808080;
+
+/**
+ * Exponents are clamped to this, anything
+ * larger overflows or underflows anyway.
+ */
+static const int64_t EXPONENT_LIMIT = 1 << 20;
+
+
+static inline unsigned count_trailing_zeros(uint64_t it) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, it);
+    return index;
+#else
+    return __builtin_ctzll(it);
+#endif
+}
+
+
+/**
+ * The value of the digit or -1
+ * if it's not a `base` digit.
+ */
+static inline int decode_digit(char it, int base) {
+    int value = -1;
+
+    if (it >= '0' && it <= '9') {
+        value = it - '0';
+    } else if (it >= 'a' && it <= 'f') {
+        value = (it - 'a') + 10;
+    } else if (it >= 'A' && it <= 'F') {
+        value = (it - 'A') + 10;
+    }
+
+    return value < base ? value : -1;
+}
+
+
+/**
+ * Sets the high bit of every byte
+ * where low <= byte <= high.
+ */
+static inline uint64_t in_range_swar(uint64_t it, unsigned char low, unsigned char high) {
+    // with the high bits cleared
+    // the sums below never carry
+    auto low_bits = it & ~HIGH_BITS;
+    auto above_low = low_bits + ONES * (0x80 - low);
+    auto above_high = low_bits + ONES * (0x7F - high);
+    return above_low & ~above_high & ~it & HIGH_BITS;
+}
+
+static inline uint64_t test_digits_swar(uint64_t it, int base) {
+    switch (base) {
+        case 2:
+            return in_range_swar(it, '0', '1');
+        case 8:
+            return in_range_swar(it, '0', '7');
+        case 10:
+            return in_range_swar(it, '0', '9');
+        default:
+            // setting 0x20 folds 'A'-'F' onto 'a'-'f'
+            return in_range_swar(it, '0', '9') | in_range_swar(it | (ONES * 0x20), 'a', 'f');
+    }
+}
+
+static inline uint64_t load_eight(const char * it) {
+    uint64_t result;
+    std::memcpy(&result, it, sizeof(result));
+    return result;
+}
+
+/**
+ * Turns "12345678" into 12345678.
+ */
+static inline uint32_t parse_eight_decimal_digits(uint64_t it) {
+    it -= ONES * '0';
+    // pairs of digits
+    it = (it * 10) + (it >> 8);
+    // pairs of pairs, pairs of those
+    it = (
+        ((it & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+        (((it >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))
+    ) >> 32;
+    return (uint32_t) it;
+}
+
+/**
+ * Turns "89abCDef" into 0x89ABCDEF.
+ */
+static inline uint32_t parse_eight_hexadecimal_digits(uint64_t it) {
+    // '0'-'9' have bit 6 cleared, letters have
+    // it set and their low nibbles are 1-6
+    it = (it & (ONES * 0x0F)) + ((it >> 6) & ONES) * 9;
+    // pack the nibbles, the first one goes highest
+    it = ((it & 0x000F000F000F000F) << 4) | ((it & 0x0F000F000F000F00) >> 8);
+    it = ((it & 0x000000FF000000FF) << 8) | ((it & 0x00FF000000FF0000) >> 16);
+    it = ((it & 0x000000000000FFFF) << 16) | ((it & 0x0000FFFF00000000) >> 32);
+    return (uint32_t) it;
+}
+
+
+/**
+ * Returns the length of the leading
+ * run of `base` digits.
+ */
+static size_t scan_digits(const char * begin, const char * end, int base) {
+    auto it = begin;
+
+#ifdef __ORDERS_LITTLE_ENDIAN__
+    while (end - it >= 8) {
+        auto stops = ~test_digits_swar(load_eight(it), base) & HIGH_BITS;
+
+        if (stops != 0) {
+            return (it - begin) + count_trailing_zeros(stops) / 8;
+        }
+
+        it += 8;
+    }
+#endif
+
+    while (it != end && decode_digit(*it, base) >= 0) {
+        it++;
+    }
+
+    return it - begin;
+}
+
+/**
+ * Appends the digits to `value`. Returns
+ * false if the result doesn't fit.
+ */
+static bool accumulate_digits(uint64_t & value, const char * begin, const char * end, int base) {
+    auto it = begin;
+    const auto max = std::numeric_limits<uint64_t>::max();
+
+#ifdef __ORDERS_LITTLE_ENDIAN__
+    if (base == 10) {
+        while (end - it >= 8) {
+            auto digits = parse_eight_decimal_digits(load_eight(it));
+
+            if (value > (max - digits) / 100000000) {
+                return false;
+            }
+
+            value = value * 100000000 + digits;
+            it += 8;
+        }
+    } else if (base == 16) {
+        while (end - it >= 8) {
+            if ((value >> 32) != 0) {
+                return false;
+            }
+
+            value = (value << 32) | parse_eight_hexadecimal_digits(load_eight(it));
+            it += 8;
+        }
+    }
+#endif
+
+    for (; it != end; it++) {
+        uint64_t digit = decode_digit(*it, base);
+
+        if (value > (max - digit) / base) {
+            return false;
+        }
+
+        value = value * base + digit;
+    }
+
+    return true;
+}
+
+
+/**
+ * from_chars does the rounding right.
+ */
+static double parse_decimal_real(const char * begin, const char * end) {
+    double value = 0.0;
+    auto result = std::from_chars(begin, end, value);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        // from_chars doesn't tell overflows from
+        // underflows, strtod returns HUGE_VAL or 0
+        value = std::strtod(std::string(begin, end).c_str(), nullptr);
+    }
+
+    return value;
+}
+
+static inline unsigned count_leading_zeros(uint64_t it) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, it);
+    return 63 - index;
+#else
+    return __builtin_clzll(it);
+#endif
+}
+
+
+/**
+ * Bases 2, 8 and 16 map to bits exactly, so the first
+ * 64 bits of the digits plus a sticky bit for the rest
+ * are enough for a single correct rounding. It's done
+ * here right to the precision of the result, converting
+ * first and scaling after would round subnormals twice.
+ */
+static double parse_binary_real(
+    const char * integer_begin, const char * integer_end,
+    const char * fraction_begin, const char * fraction_end,
+    int64_t exponent, int base
+) {
+    int bits = base == 2 ? 1 : base == 8 ? 3 : 4;
+    uint64_t mantissa = 0;
+    int64_t shift = 0;
+    bool is_sticky = false;
+
+    auto push = [&](const char * begin, const char * end, bool is_fraction) {
+        for (auto it = begin; it != end; it++) {
+            auto digit = decode_digit(*it, base);
+
+            if ((mantissa >> (64 - bits)) == 0) {
+                mantissa = (mantissa << bits) | digit;
+                shift -= is_fraction ? bits : 0;
+            } else {
+                is_sticky |= digit != 0;
+                shift += is_fraction ? 0 : bits;
+            }
+        }
+    };
+
+    push(integer_begin, integer_end, false);
+    push(fraction_begin, fraction_end, true);
+
+    // the sticky bit is only ever set
+    // once the mantissa is full
+    if (mantissa == 0) {
+        return 0.0;
+    }
+
+    shift += exponent * bits;
+    shift = std::max(-EXPONENT_LIMIT, std::min(shift, EXPONENT_LIMIT));
+
+    // the value is mantissa * 2^shift,
+    // with the mantissa in [2^63, 2^64)
+    auto zeros = count_leading_zeros(mantissa);
+    mantissa <<= zeros;
+    shift -= zeros;
+
+    // 53 bits are kept for normal numbers, but
+    // nothing below 2^-1074 for subnormal ones
+    const int64_t MANTISSA_BITS = 53;
+    const int64_t LOWEST_EXPONENT = -1074;
+    auto dropped = std::max(64 - MANTISSA_BITS, LOWEST_EXPONENT - shift);
+
+    if (dropped > 64) {
+        // below half of the smallest subnormal
+        return 0.0;
+    }
+
+    uint64_t kept = dropped == 64 ? 0 : mantissa >> dropped;
+    uint64_t rest = dropped == 64 ? mantissa : mantissa & ((1ULL << dropped) - 1);
+    uint64_t half = 1ULL << (dropped - 1);
+
+    // to nearest, ties to even
+    if (rest > half || (rest == half && (is_sticky || (kept & 1) != 0))) {
+        kept += 1;
+    }
+
+    // exact, `kept` has at most 54 bits and
+    // the smallest unit is representable
+    return std::ldexp((double) kept, (int) (shift + dropped));
+}
+
+
+orders::ParsedNumber orders::parse_number(const char * begin, const char * end, int base) {
+    ParsedNumber result;
+    auto it = begin;
+
+    auto integer_begin = it;
+    it += scan_digits(it, end, base);
+    auto integer_end = it;
+
+    auto fraction_begin = it;
+    auto fraction_end = it;
+
+    if (it != end && *it == '.') {
+        result.is_real = true;
+        fraction_begin = ++it;
+        it += scan_digits(it, end, base);
+        fraction_end = it;
+    }
+
+    bool is_exponent_negative = false;
+    auto exponent_begin = it;
+    auto exponent_end = it;
+
+    if (base != 16 && it != end && (*it == 'e' || *it == 'E')) {
+        auto exponent = it + 1;
+        bool is_negative = false;
+
+        if (exponent != end && (*exponent == '+' || *exponent == '-')) {
+            is_negative = *exponent == '-';
+            exponent++;
+        }
+
+        auto digits_count = scan_digits(exponent, end, base);
+
+        // `1e` is `1` followed by
+        // something else
+        if (digits_count > 0) {
+            result.is_real = true;
+            is_exponent_negative = is_negative;
+            exponent_begin = exponent;
+            exponent_end = exponent + digits_count;
+            it = exponent_end;
+        }
+    }
+
+    result.length = it - begin;
+
+    if (!result.is_real) {
+        uint64_t value = 0;
+        auto max = (uint64_t) std::numeric_limits<int64_t>::max();
+
+        if (!accumulate_digits(value, integer_begin, integer_end, base) || value > max) {
+            result.is_overflow = true;
+            value = max;
+        }
+
+        result.integer = (int64_t) value;
+        return result;
+    }
+
+    if (base == 10) {
+        result.real = parse_decimal_real(begin, it);
+    } else {
+        uint64_t exponent = 0;
+
+        if (!accumulate_digits(exponent, exponent_begin, exponent_end, base) || exponent > EXPONENT_LIMIT) {
+            exponent = EXPONENT_LIMIT;
+        }
+
+        result.real = parse_binary_real(
+            integer_begin, integer_end,
+            fraction_begin, fraction_end,
+            is_exponent_negative ? -(int64_t) exponent : (int64_t) exponent,
+            base
+        );
+    }
+
+    result.is_overflow = std::isinf(result.real);
+    return result;
+}
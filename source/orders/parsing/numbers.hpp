@@ -0,0 +1,54 @@
+// Copyright (C) 2020 luna_koly
+//
+// Decodes number literals in bases 2, 8,
+// 10 and 16. Decimal and hexadecimal digits
+// are processed 8 at a time.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace orders {
+    /**
+     * What `parse_number` has found.
+     */
+    struct ParsedNumber {
+        /**
+         * Number of characters the
+         * literal consists of.
+         */
+        size_t length = 0;
+        /**
+         * True if there was a fraction
+         * or an exponent.
+         */
+        bool is_real = false;
+        /**
+         * True if the value doesn't fit into
+         * int64_t (or double). `integer` is
+         * INT64_MAX then, `real` is infinity.
+         */
+        bool is_overflow = false;
+        /**
+         * The value if `!is_real`.
+         */
+        int64_t integer = 0;
+        /**
+         * The value if `is_real`, correctly
+         * rounded to the nearest double.
+         */
+        double real = 0.0;
+    };
+
+    /**
+     * Parses `digits ['.' digits] [('e' | 'E') [sign] digits]`
+     * at the start of the range. Exponent digits are in
+     * the same `base`, and the exponent itself is a power
+     * of `base`. Hexadecimal literals have no exponent,
+     * because 'e' is a digit there.
+     */
+    ParsedNumber parse_number(const char * begin, const char * end, int base);
+}
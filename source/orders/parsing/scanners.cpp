@@ -0,0 +1,318 @@
+#include "scanners.hpp"
+
+#include <bitset>
+#include <cstdint>
+
+// SSE2 is only guaranteed on x86-64
+#if defined(__x86_64__) || defined(_M_X64)
+    #define __ORDERS_X86__
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        // MSVC allows AVX2 intrinsics anywhere
+        #define __ORDERS_AVX2__
+    #else
+        #define __ORDERS_AVX2__ __attribute__((target("avx2")))
+    #endif
+#endif
+
+
+/**
+ * The kinds of runs the scanners know.
+ */
+enum class CharacterClass {
+    SPACE, IDENTIFIER
+};
+
+
+static inline unsigned count_trailing_zeros(uint32_t it) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, it);
+    return index;
+#else
+    return __builtin_ctz(it);
+#endif
+}
+
+
+static inline unsigned count_ones(uint32_t it) {
+#if defined(_MSC_VER)
+    return (unsigned) std::bitset<32>(it).count();
+#else
+    return __builtin_popcount(it);
+#endif
+}
+
+
+template <CharacterClass C>
+static inline bool test_scalar(char it) {
+    if constexpr (C == CharacterClass::SPACE) {
+        return it == ' ' || it == '\t' || it == '\r';
+    } else {
+        return
+            (it >= 'a' && it <= 'z') ||
+            (it >= 'A' && it <= 'Z') ||
+            (it >= '0' && it <= '9') ||
+            it == '_';
+    }
+}
+
+/**
+ * Returns the length of the leading run of
+ * characters for which `test_scalar<C>() == run_of`.
+ */
+template <CharacterClass C, bool run_of>
+static size_t scan_scalar(const char * begin, const char * end) {
+    auto it = begin;
+
+    while (it != end && test_scalar<C>(*it) == run_of) {
+        it++;
+    }
+
+    return it - begin;
+}
+
+static size_t count_scalar(const char * begin, const char * end, char character) {
+    size_t count = 0;
+
+    for (auto it = begin; it != end; it++) {
+        count += *it == character;
+    }
+
+    return count;
+}
+
+
+#ifdef __ORDERS_X86__
+
+/**
+ * 0xFF where low <= it <= high. Bytes >= 0x80
+ * are negative here, so they never match.
+ */
+static inline __m128i in_range_sse2(__m128i it, char low, char high) {
+    return _mm_and_si128(
+        _mm_cmpgt_epi8(it, _mm_set1_epi8(low - 1)),
+        _mm_cmplt_epi8(it, _mm_set1_epi8(high + 1))
+    );
+}
+
+template <CharacterClass C>
+static inline uint32_t test_sse2(__m128i it) {
+    __m128i result;
+
+    if constexpr (C == CharacterClass::SPACE) {
+        result = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(it, _mm_set1_epi8(' ')),
+                _mm_cmpeq_epi8(it, _mm_set1_epi8('\t'))
+            ),
+            _mm_cmpeq_epi8(it, _mm_set1_epi8('\r'))
+        );
+    } else {
+        // setting 0x20 folds 'A'-'Z' onto 'a'-'z'
+        auto lowercase = _mm_or_si128(it, _mm_set1_epi8(0x20));
+
+        result = _mm_or_si128(
+            _mm_or_si128(
+                in_range_sse2(lowercase, 'a', 'z'),
+                in_range_sse2(it, '0', '9')
+            ),
+            _mm_cmpeq_epi8(it, _mm_set1_epi8('_'))
+        );
+    }
+
+    return (uint32_t) _mm_movemask_epi8(result);
+}
+
+template <CharacterClass C, bool run_of>
+static size_t scan_sse2(const char * begin, const char * end) {
+    auto it = begin;
+
+    while (end - it >= 16) {
+        auto matches = test_sse2<C>(_mm_loadu_si128((const __m128i *) it));
+        auto stops = (run_of ? ~matches : matches) & 0xFFFF;
+
+        if (stops != 0) {
+            return (it - begin) + count_trailing_zeros(stops);
+        }
+
+        it += 16;
+    }
+
+    return (it - begin) + scan_scalar<C, run_of>(it, end);
+}
+
+static size_t count_sse2(const char * begin, const char * end, char character) {
+    auto it = begin;
+    auto target = _mm_set1_epi8(character);
+    size_t count = 0;
+
+    while (end - it >= 16) {
+        auto matches = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) it), target);
+        count += count_ones((uint32_t) _mm_movemask_epi8(matches));
+        it += 16;
+    }
+
+    return count + count_scalar(it, end, character);
+}
+
+
+__ORDERS_AVX2__ static inline __m256i in_range_avx2(__m256i it, char low, char high) {
+    return _mm256_and_si256(
+        _mm256_cmpgt_epi8(it, _mm256_set1_epi8(low - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), it)
+    );
+}
+
+template <CharacterClass C>
+__ORDERS_AVX2__ static inline uint32_t test_avx2(__m256i it) {
+    __m256i result;
+
+    if constexpr (C == CharacterClass::SPACE) {
+        result = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(it, _mm256_set1_epi8(' ')),
+                _mm256_cmpeq_epi8(it, _mm256_set1_epi8('\t'))
+            ),
+            _mm256_cmpeq_epi8(it, _mm256_set1_epi8('\r'))
+        );
+    } else {
+        auto lowercase = _mm256_or_si256(it, _mm256_set1_epi8(0x20));
+
+        result = _mm256_or_si256(
+            _mm256_or_si256(
+                in_range_avx2(lowercase, 'a', 'z'),
+                in_range_avx2(it, '0', '9')
+            ),
+            _mm256_cmpeq_epi8(it, _mm256_set1_epi8('_'))
+        );
+    }
+
+    return (uint32_t) _mm256_movemask_epi8(result);
+}
+
+template <CharacterClass C, bool run_of>
+__ORDERS_AVX2__ static size_t scan_avx2(const char * begin, const char * end) {
+    auto it = begin;
+
+    while (end - it >= 32) {
+        auto matches = test_avx2<C>(_mm256_loadu_si256((const __m256i *) it));
+        auto stops = run_of ? ~matches : matches;
+
+        if (stops != 0) {
+            return (it - begin) + count_trailing_zeros(stops);
+        }
+
+        it += 32;
+    }
+
+    // the tail is short, the SSE2 path will do
+    return (it - begin) + scan_sse2<C, run_of>(it, end);
+}
+
+__ORDERS_AVX2__ static size_t count_avx2(const char * begin, const char * end, char character) {
+    auto it = begin;
+    auto target = _mm256_set1_epi8(character);
+    size_t count = 0;
+
+    while (end - it >= 32) {
+        auto matches = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) it), target);
+        count += count_ones((uint32_t) _mm256_movemask_epi8(matches));
+        it += 32;
+    }
+
+    return count + count_sse2(it, end, character);
+}
+
+
+/**
+ * True if both the CPU and the OS
+ * support AVX2.
+ */
+static bool is_avx2_supported() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+
+    bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    bool has_avx = (info[2] & (1 << 28)) != 0;
+
+    if (!has_osxsave || !has_avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+
+/**
+ * The implementations chosen for this CPU.
+ */
+struct Scanners {
+    const char * name;
+    size_t (*spaces)(const char *, const char *);
+    size_t (*non_spaces)(const char *, const char *);
+    size_t (*identifier)(const char *, const char *);
+    size_t (*count)(const char *, const char *, char);
+};
+
+static Scanners choose_scanners() {
+#ifdef __ORDERS_X86__
+    if (is_avx2_supported()) {
+        return Scanners{
+            "avx2",
+            scan_avx2<CharacterClass::SPACE, true>,
+            scan_avx2<CharacterClass::SPACE, false>,
+            scan_avx2<CharacterClass::IDENTIFIER, true>,
+            count_avx2
+        };
+    }
+
+    return Scanners{
+        "sse2",
+        scan_sse2<CharacterClass::SPACE, true>,
+        scan_sse2<CharacterClass::SPACE, false>,
+        scan_sse2<CharacterClass::IDENTIFIER, true>,
+        count_sse2
+    };
+#else
+    return Scanners{
+        "scalar",
+        scan_scalar<CharacterClass::SPACE, true>,
+        scan_scalar<CharacterClass::SPACE, false>,
+        scan_scalar<CharacterClass::IDENTIFIER, true>,
+        count_scalar
+    };
+#endif
+}
+
+static const Scanners SCANNERS = choose_scanners();
+
+
+size_t orders::scan_spaces(const char * begin, const char * end) {
+    return SCANNERS.spaces(begin, end);
+}
+
+size_t orders::scan_non_spaces(const char * begin, const char * end) {
+    return SCANNERS.non_spaces(begin, end);
+}
+
+size_t orders::scan_identifier(const char * begin, const char * end) {
+    return SCANNERS.identifier(begin, end);
+}
+
+size_t orders::count_character(const char * begin, const char * end, char it) {
+    return SCANNERS.count(begin, end, it);
+}
+
+const char * orders::get_scanners_name() {
+    return SCANNERS.name;
+}
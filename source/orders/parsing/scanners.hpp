@@ -0,0 +1,42 @@
+// Copyright (C) 2020 luna_koly
+//
+// Finds the ends of character runs
+// (whitespaces, identifiers, etc.) 16 or
+// 32 bytes at a time when the CPU allows.
+
+
+#pragma once
+
+#include <cstddef>
+
+
+namespace orders {
+    /**
+     * Returns the length of the leading
+     * run of ' ', '\t' and '\r'.
+     */
+    size_t scan_spaces(const char * begin, const char * end);
+
+    /**
+     * Returns the length of the leading run
+     * of anything except ' ', '\t' and '\r'.
+     */
+    size_t scan_non_spaces(const char * begin, const char * end);
+
+    /**
+     * Returns the length of the leading
+     * run of [a-zA-Z0-9_].
+     */
+    size_t scan_identifier(const char * begin, const char * end);
+
+    /**
+     * Returns the number of `it`'s in the range.
+     */
+    size_t count_character(const char * begin, const char * end, char it);
+
+    /**
+     * The instruction set the scanners use:
+     * "avx2", "sse2" or "scalar".
+     */
+    const char * get_scanners_name();
+}
@@ -0,0 +1,120 @@
+#include "sources.hpp"
+
+#include "scanners.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+
+orders::FileId orders::SourceManager::add(std::string filename, std::string text) {
+    auto file = std::make_unique<File>();
+    file->filename = std::move(filename);
+    file->text = std::move(text);
+
+    std::lock_guard lock(files_protector);
+    files.push_back(std::move(file));
+    return (FileId) (files.size() - 1);
+}
+
+const orders::SourceManager::File & orders::SourceManager::get_file(FileId file) const {
+    std::lock_guard lock(files_protector);
+    return *files[file];
+}
+
+const std::string & orders::SourceManager::get_filename(FileId file) const {
+    return get_file(file).filename;
+}
+
+std::string_view orders::SourceManager::get_text(FileId file) const {
+    return get_file(file).text;
+}
+
+const std::vector<size_t> & orders::SourceManager::get_line_starts(const File & file) const {
+    std::call_once(file.line_starts_flag, [&]() {
+        auto begin = file.text.data();
+        auto end = begin + file.text.size();
+
+        file.line_starts.reserve(count_character(begin, end, '\n') + 1);
+        file.line_starts.push_back(0);
+
+        for (auto it = begin; it != end; it++) {
+            it = (const char *) std::memchr(it, '\n', end - it);
+
+            if (it == nullptr) {
+                break;
+            }
+
+            file.line_starts.push_back((it - begin) + 1);
+        }
+    });
+
+    return file.line_starts;
+}
+
+orders::Location orders::SourceManager::locate(FileId file, size_t offset) const {
+    auto & line_starts = get_line_starts(get_file(file));
+    auto next_line = std::upper_bound(line_starts.begin(), line_starts.end(), offset);
+    auto line = (size_t) (next_line - line_starts.begin());
+
+    return Location{line, offset - line_starts[line - 1] + 1};
+}
+
+std::string_view orders::SourceManager::get_line(FileId file, size_t line) const {
+    auto & that = get_file(file);
+    auto & line_starts = get_line_starts(that);
+
+    if (line == 0 || line > line_starts.size()) {
+        return std::string_view();
+    }
+
+    auto start = line_starts[line - 1];
+    auto stop = line < line_starts.size() ? line_starts[line] - 1 : that.text.size();
+
+    std::string_view result(that.text.data() + start, stop - start);
+
+    if (!result.empty() && result.back() == '\r') {
+        result.remove_suffix(1);
+    }
+
+    return result;
+}
+
+void orders::SourceManager::render(std::ostream & output, FileId file, Range range) const {
+    if (file == NO_FILE) {
+        output << "[MISSING_VISUALIZATION]" << '\n';
+        return;
+    }
+
+    if (range.is_none()) {
+        output << "[MISSING_VISUALIZATION]" << '\n';
+        output << "Quick Link > " << get_filename(file) << '\n';
+        return;
+    }
+
+    auto location = locate(file, range.start);
+    auto line = get_line(file, location.line);
+    auto prefix = ' ' + std::to_string(location.line) + " | ";
+
+    output << prefix << line << '\n';
+
+    // the range is underlined within
+    // its first line only
+    auto start = std::min(location.column - 1, line.size());
+    auto length = range.stop > range.start ? range.stop - range.start : 1;
+    auto stop = std::max(start + 1, std::min(start + length, line.size()));
+
+    std::string highlight(prefix.size() - 2, ' ');
+    highlight += "| ";
+
+    // keep tabs, so that the marks
+    // line up with the text
+    for (size_t it = 0; it < start; it++) {
+        highlight += line[it] == '\t' ? '\t' : ' ';
+    }
+
+    highlight += '^';
+    highlight.append(stop - start - 1, '~');
+
+    output << highlight << '\n';
+    output << "Quick Link > " << get_filename(file) << "(" << location.line << "," << location.column << ")" << '\n';
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2020 luna_koly
+//
+// Keeps the texts of all the input files,
+// so that diagnostics may refer to them by
+// an id and a range, and the surrounding
+// lines are only looked up when printing.
+
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "diagnostics.hpp"
+
+
+namespace orders {
+    /**
+     * A line and a column, both 1-based.
+     */
+    struct Location {
+        size_t line;
+        size_t column;
+    };
+
+    /**
+     * Owns the file texts. Files may be added
+     * from several threads at once.
+     */
+    class SourceManager {
+    public:
+        /**
+         * Takes the text and returns the id
+         * diagnostics should refer to.
+         */
+        FileId add(std::string filename, std::string text);
+
+        const std::string & get_filename(FileId file) const;
+
+        /**
+         * Stays valid as long as the
+         * manager lives.
+         */
+        std::string_view get_text(FileId file) const;
+
+        /**
+         * Finds the line and the column of
+         * the offset. Line starts are computed
+         * on the first call for the file.
+         */
+        Location locate(FileId file, size_t offset) const;
+
+        /**
+         * The text of the 1-based line
+         * without the line break.
+         */
+        std::string_view get_line(FileId file, size_t line) const;
+
+        /**
+         * Prints the line containing `range.start`
+         * with the range underlined, followed by
+         * a link to the place. Without a range,
+         * only the file is linked.
+         */
+        void render(std::ostream & output, FileId file, Range range) const;
+
+    private:
+        struct File {
+            std::string filename;
+            std::string text;
+            /**
+             * Offsets the lines start at,
+             * filled lazily.
+             */
+            mutable std::vector<size_t> line_starts;
+            mutable std::once_flag line_starts_flag;
+        };
+
+        /**
+         * unique_ptr's keep the files in place
+         * while the deque grows.
+         */
+        std::deque<std::unique_ptr<File>> files;
+        mutable std::mutex files_protector;
+
+        const File & get_file(FileId file) const;
+
+        const std::vector<size_t> & get_line_starts(const File & file) const;
+    };
+}
@@ -0,0 +1,128 @@
+#include "source_stream.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+
+orders::SourceStream::SourceStream(std::string_view source, size_t buffer_size, size_t buffer_indent)
+    : buffer_size(buffer_size)
+    , buffer_indent(buffer_indent)
+    , source(source)
+    {}
+
+int orders::SourceStream::get_end_value() const {
+    return EOF;
+}
+
+int orders::SourceStream::peek() {
+    return lookahead(0);
+}
+
+bool orders::SourceStream::has_next() {
+    return offset < source.size();
+}
+
+void orders::SourceStream::step() {
+    offset += 1;
+}
+
+void orders::SourceStream::step(size_t count) {
+    offset += count;
+}
+
+size_t orders::SourceStream::get_offset() const {
+    return offset;
+}
+
+int orders::SourceStream::lookahead(size_t position) const {
+    auto index = offset + position;
+
+    if (index < source.size()) {
+        return (unsigned char) source[index];
+    }
+
+    return EOF;
+}
+
+std::string orders::SourceStream::get_text() const {
+    // the same window a ring buffer of `buffer_size`
+    // would hold: zeros before the start, EOF's after the end
+    std::string result(buffer_size, '\0');
+
+    for (size_t it = 0; it < buffer_size; it++) {
+        auto index = offset + it;
+
+        if (index < buffer_indent) {
+            continue;
+        }
+
+        index -= buffer_indent;
+
+        if (index < source.size()) {
+            result[it] = source[index];
+        } else {
+            result[it] = (char) EOF;
+        }
+    }
+
+    return result;
+}
+
+size_t orders::SourceStream::match(const char * next) const {
+    auto length = std::strlen(next);
+
+    if (offset + length > source.size()) {
+        return 0;
+    }
+
+    if (source.compare(offset, length, next, length) == 0) {
+        return length;
+    }
+
+    return 0;
+}
+
+void orders::SourceStream::clear() {
+    lexeme_start = offset;
+}
+
+std::string orders::SourceStream::revise(size_t position) const {
+    std::string result;
+
+    if (position < source.size()) {
+        auto stop = offset < source.size() ? offset : source.size();
+        result.assign(source.substr(position, stop - position));
+    }
+
+    // stepping over the end accumulates EOF's
+    if (offset > source.size()) {
+        auto start = position > source.size() ? position : source.size();
+        result.append(offset - start, (char) EOF);
+    }
+
+    return result;
+}
+
+std::string orders::SourceStream::revise_all() const {
+    return revise(lexeme_start);
+}
+
+const char * orders::SourceStream::get_current() const {
+    if (offset < source.size()) {
+        return source.data() + offset;
+    }
+
+    return get_end();
+}
+
+const char * orders::SourceStream::get_end() const {
+    return source.data() + source.size();
+}
+
+std::string_view orders::SourceStream::get_source() const {
+    return source;
+}
+
+__IMPLEMENT_PRINT__(orders::SourceStream) {
+    return output << "SourceStream [" << offset << " / " << source.size() << "]";
+}
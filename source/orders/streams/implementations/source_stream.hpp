@@ -0,0 +1,97 @@
+// Copyright (C) 2020 luna_koly
+//
+// A TextStream over the whole text kept
+// in memory. Lexemes are slices of it, and
+// scanners may look at the raw characters
+// instead of stepping one by one.
+
+
+#pragma once
+
+#include "../buffered_stream.hpp"
+#include "../accumulator_stream.hpp"
+
+#include <string>
+#include <string_view>
+
+
+namespace orders {
+    /**
+     * Works over a contiguous text. The text
+     * must outlive the stream.
+     */
+    class SourceStream : public virtual TextStream, public virtual AccumulatorStream {
+    public:
+        __WITH_CUSTOM_PRINT__
+
+        /**
+         * Size of the window `get_text()` returns.
+         */
+        const size_t buffer_size;
+        /**
+         * The number of positions the window
+         * starts before the current one.
+         */
+        const size_t buffer_indent;
+
+        /**
+         * The window parameters mimic the
+         * ones of the SimpleBufferedStream.
+         */
+        SourceStream(std::string_view source, size_t buffer_size = 16, size_t buffer_indent = 5);
+
+        virtual int get_end_value() const override;
+
+        virtual int peek() override;
+
+        virtual bool has_next() override;
+
+        virtual void step() override;
+
+        virtual void step(size_t count) override;
+
+        virtual size_t get_offset() const override;
+
+        virtual int lookahead(size_t position) const override;
+
+        virtual std::string get_text() const override;
+
+        virtual size_t match(const char * next) const override;
+
+        virtual void clear() override;
+
+        virtual std::string revise(size_t position) const override;
+
+        virtual std::string revise_all() const override;
+
+        /**
+         * Points to the current character.
+         */
+        const char * get_current() const;
+
+        /**
+         * Points past the last character.
+         */
+        const char * get_end() const;
+
+        /**
+         * The whole underlying text.
+         */
+        std::string_view get_source() const;
+
+    private:
+        /**
+         * The text itself.
+         */
+        const std::string_view source;
+        /**
+         * Number of read characters. May go past
+         * the end if someone steps over EOF.
+         */
+        size_t offset = 0;
+        /**
+         * Where the current lexeme starts.
+         */
+        size_t lexeme_start = 0;
+    };
+}
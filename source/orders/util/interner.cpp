@@ -0,0 +1,185 @@
+#include "interner.hpp"
+
+#include <cstring>
+#include <iostream>
+
+
+/**
+ * Texts are copied into blocks of at least
+ * this size, longer ones get their own block.
+ */
+static const size_t BLOCK_SIZE = 4096;
+
+static const size_t INITIAL_SLOTS_COUNT = 64;
+
+
+orders::Interner::Interner() : shards(new Shard[SHARDS_COUNT]) {}
+
+size_t orders::Interner::hash(std::string_view text) {
+    return std::hash<std::string_view>{}(text);
+}
+
+orders::Interner::Shard & orders::Interner::get_shard(size_t hash) const {
+    // the lower bits pick the slot
+    // inside the shard's table
+    return shards[hash >> (sizeof(size_t) * 8 - SHARD_BITS)];
+}
+
+
+uint32_t orders::Interner::Shard::lookup(std::string_view text, size_t hash) const {
+    if (slots.empty()) {
+        return 0;
+    }
+
+    auto mask = slots.size() - 1;
+
+    for (auto it = hash & mask; slots[it] != 0; it = (it + 1) & mask) {
+        auto & entry = entries[slots[it] - 1];
+
+        if (entry.hash == hash && entry.text == text) {
+            return slots[it];
+        }
+    }
+
+    return 0;
+}
+
+std::string_view orders::Interner::Shard::store(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+
+    if (block_used + text.size() > block_size) {
+        block_size = text.size() > BLOCK_SIZE ? text.size() : BLOCK_SIZE;
+        block_used = 0;
+        blocks.emplace_back(new char[block_size]);
+        allocated_bytes += block_size;
+    }
+
+    auto destination = blocks.back().get() + block_used;
+    std::memcpy(destination, text.data(), text.size());
+
+    block_used += text.size();
+
+    return std::string_view(destination, text.size());
+}
+
+void orders::Interner::Shard::grow() {
+    auto size = slots.empty() ? INITIAL_SLOTS_COUNT : slots.size() * 2;
+    auto mask = size - 1;
+
+    slots.assign(size, 0);
+
+    for (size_t index = 0; index < entries.size(); index++) {
+        auto it = entries[index].hash & mask;
+
+        while (slots[it] != 0) {
+            it = (it + 1) & mask;
+        }
+
+        slots[it] = (uint32_t) index + 1;
+    }
+}
+
+
+orders::Symbol orders::Interner::intern(std::string_view text) {
+    auto text_hash = hash(text);
+    auto & shard = get_shard(text_hash);
+    uint32_t shard_index = (uint32_t) (&shard - shards.get());
+
+    std::lock_guard lock(shard.protector);
+    auto found = shard.lookup(text, text_hash);
+
+    if (found != 0) {
+        return Symbol{((found - 1) << SHARD_BITS) | shard_index};
+    }
+
+    // the index must leave room for the shard
+    // bits and must not compose into NONE
+    if (shard.entries.size() >= MAX_SHARD_ENTRIES) {
+        std::cerr << "!!Interner has run out of symbol ids in shard `" << shard_index << "`!!" << std::endl;
+        std::terminate();
+    }
+
+    // keep the load factor below 1/2
+    if ((shard.entries.size() + 1) * 2 > shard.slots.size()) {
+        shard.entries.push_back(Entry{shard.store(text), text_hash});
+        shard.grow();
+    } else {
+        shard.entries.push_back(Entry{shard.store(text), text_hash});
+
+        auto mask = shard.slots.size() - 1;
+        auto it = text_hash & mask;
+
+        while (shard.slots[it] != 0) {
+            it = (it + 1) & mask;
+        }
+
+        shard.slots[it] = (uint32_t) shard.entries.size();
+    }
+
+    auto index = (uint32_t) shard.entries.size() - 1;
+    return Symbol{(index << SHARD_BITS) | shard_index};
+}
+
+orders::Symbol orders::Interner::find(std::string_view text) const {
+    auto text_hash = hash(text);
+    auto & shard = get_shard(text_hash);
+    uint32_t shard_index = (uint32_t) (&shard - shards.get());
+
+    std::lock_guard lock(shard.protector);
+    auto found = shard.lookup(text, text_hash);
+
+    if (found != 0) {
+        return Symbol{((found - 1) << SHARD_BITS) | shard_index};
+    }
+
+    return Symbol{};
+}
+
+std::string_view orders::Interner::get_text(Symbol symbol) const {
+    if (symbol.is_none()) {
+        return std::string_view();
+    }
+
+    auto & shard = shards[symbol.id & (SHARDS_COUNT - 1)];
+    std::lock_guard lock(shard.protector);
+    return shard.entries[symbol.id >> SHARD_BITS].text;
+}
+
+size_t orders::Interner::get_hash(Symbol symbol) const {
+    if (symbol.is_none()) {
+        return hash(std::string_view());
+    }
+
+    auto & shard = shards[symbol.id & (SHARDS_COUNT - 1)];
+    std::lock_guard lock(shard.protector);
+    return shard.entries[symbol.id >> SHARD_BITS].hash;
+}
+
+size_t orders::Interner::get_symbols_count() const {
+    size_t result = 0;
+
+    for (uint32_t it = 0; it < SHARDS_COUNT; it++) {
+        std::lock_guard lock(shards[it].protector);
+        result += shards[it].entries.size();
+    }
+
+    return result;
+}
+
+size_t orders::Interner::get_memory_usage() const {
+    size_t result = sizeof(Shard) * SHARDS_COUNT;
+
+    for (uint32_t it = 0; it < SHARDS_COUNT; it++) {
+        auto & shard = shards[it];
+        std::lock_guard lock(shard.protector);
+
+        result += shard.entries.size() * sizeof(Entry);
+        result += shard.slots.capacity() * sizeof(uint32_t);
+        result += shard.blocks.capacity() * sizeof(std::unique_ptr<char[]>);
+        result += shard.allocated_bytes;
+    }
+
+    return result;
+}
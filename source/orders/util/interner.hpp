@@ -0,0 +1,164 @@
+// Copyright (C) 2020 luna_koly
+//
+// Maps strings to small ids, so that equal
+// names are compared by a single integer.
+// Several threads may intern at once.
+
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+
+namespace orders {
+    /**
+     * An interned string.
+     */
+    struct Symbol {
+        /**
+         * The shard index lives in the lower
+         * bits, the index in the shard above.
+         */
+        uint32_t id = NONE;
+
+        /**
+         * Marks symbols that haven't
+         * been interned.
+         */
+        static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+        bool is_none() const {
+            return id == NONE;
+        }
+
+        bool operator == (const Symbol & other) const {
+            return id == other.id;
+        }
+
+        bool operator != (const Symbol & other) const {
+            return id != other.id;
+        }
+
+        bool operator < (const Symbol & other) const {
+            return id < other.id;
+        }
+    };
+
+    /**
+     * Owns the strings. Interned texts stay
+     * valid for the lifetime of the interner.
+     */
+    class Interner {
+    public:
+        /**
+         * Shards are picked by hash, each
+         * one has its own lock.
+         */
+        static constexpr uint32_t SHARD_BITS = 6;
+        static constexpr uint32_t SHARDS_COUNT = 1 << SHARD_BITS;
+        /**
+         * The most texts a single shard can hold
+         * before `index << SHARD_BITS` overflows.
+         */
+        static constexpr size_t MAX_SHARD_ENTRIES = Symbol::NONE >> SHARD_BITS;
+
+        Interner();
+
+        Interner(const Interner &) = delete;
+        Interner & operator = (const Interner &) = delete;
+
+        /**
+         * Returns the symbol for the text,
+         * adding it if needed.
+         */
+        Symbol intern(std::string_view text);
+
+        /**
+         * Returns the symbol for the text
+         * if it's already been interned.
+         */
+        Symbol find(std::string_view text) const;
+
+        /**
+         * The text behind the symbol.
+         */
+        std::string_view get_text(Symbol symbol) const;
+
+        /**
+         * The hash of the text behind the
+         * symbol, computed at interning.
+         */
+        size_t get_hash(Symbol symbol) const;
+
+        /**
+         * Number of distinct strings.
+         */
+        size_t get_symbols_count() const;
+
+        /**
+         * Bytes allocated for the texts, the
+         * entries and the hash tables.
+         */
+        size_t get_memory_usage() const;
+
+    private:
+        struct Entry {
+            std::string_view text;
+            size_t hash;
+        };
+
+        struct alignas(64) Shard {
+            mutable std::mutex protector;
+            /**
+             * Never moves its elements, so
+             * `text`s remain valid.
+             */
+            std::deque<Entry> entries;
+            /**
+             * Open addressing, holds
+             * entry index + 1, 0 if free.
+             */
+            std::vector<uint32_t> slots;
+            /**
+             * Memory for the texts.
+             */
+            std::vector<std::unique_ptr<char[]>> blocks;
+            size_t block_used = 0;
+            size_t block_size = 0;
+            size_t allocated_bytes = 0;
+
+            /**
+             * Returns the entry index + 1,
+             * 0 if not found.
+             */
+            uint32_t lookup(std::string_view text, size_t hash) const;
+
+            std::string_view store(std::string_view text);
+
+            void grow();
+        };
+
+        std::unique_ptr<Shard[]> shards;
+
+        static size_t hash(std::string_view text);
+
+        Shard & get_shard(size_t hash) const;
+    };
+}
+
+
+namespace std {
+    template <>
+    struct hash<orders::Symbol> {
+        size_t operator () (const orders::Symbol & it) const noexcept {
+            return std::hash<uint32_t>{}(it.id);
+        }
+    };
+}
@@ -0,0 +1,137 @@
+// Copyright (C) 2020 luna_koly
+//
+// A bounded lock-free multi-producer
+// multi-consumer queue (the ring buffer
+// with per-cell sequence numbers).
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+
+namespace threading {
+    /**
+     * A fixed-size ring of T's that many threads
+     * may push to and pop from without locks.
+     */
+    template <typename T>
+    class BoundedQueue {
+    public:
+        /**
+         * The capacity is rounded up to
+         * the next power of two.
+         */
+        BoundedQueue(size_t capacity) {
+            size_t size = 2;
+
+            while (size < capacity) {
+                size *= 2;
+            }
+
+            mask = size - 1;
+            cells = std::make_unique<Cell[]>(size);
+
+            for (size_t it = 0; it < size; it++) {
+                cells[it].sequence.store(it, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue & operator = (const BoundedQueue &) = delete;
+
+        /**
+         * Returns false if the queue is full.
+         * `value` is left untouched then.
+         */
+        bool try_push(T && value) {
+            auto position = enqueue_position.load(std::memory_order_relaxed);
+            Cell * cell;
+
+            while (true) {
+                cell = &cells[position & mask];
+                auto sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = (intptr_t) sequence - (intptr_t) position;
+
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = std::move(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Returns false if the queue is empty.
+         */
+        bool try_pop(T & value) {
+            auto position = dequeue_position.load(std::memory_order_relaxed);
+            Cell * cell;
+
+            while (true) {
+                cell = &cells[position & mask];
+                auto sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = (intptr_t) sequence - (intptr_t) (position + 1);
+
+                if (difference == 0) {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = std::move(cell->value);
+            cell->sequence.store(position + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Returns the number of cells.
+         */
+        size_t get_capacity() const {
+            return mask + 1;
+        }
+
+    private:
+        struct Cell {
+            /**
+             * Equals the position the cell
+             * expects to be written at, or that
+             * position + 1 once it holds a value.
+             */
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        /**
+         * Actual storage.
+         */
+        std::unique_ptr<Cell[]> cells;
+        /**
+         * capacity - 1.
+         */
+        size_t mask;
+        /**
+         * Producers and consumers touch different
+         * counters, keep them on different cache lines.
+         */
+        alignas(64) std::atomic<size_t> enqueue_position = 0;
+        alignas(64) std::atomic<size_t> dequeue_position = 0;
+    };
+}
@@ -0,0 +1,275 @@
+#include "concurrency.hpp"
+
+#include <cmath>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <optional>
+
+#if defined(__linux__)
+    #include <sched.h>
+    #include <pthread.h>
+#elif defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#endif
+
+
+using namespace threading;
+
+
+#if defined(__linux__)
+/**
+ * Where a cgroup hierarchy is mounted
+ * and which cgroup its root shows.
+ */
+struct CgroupMount {
+    std::string root;
+    std::string point;
+};
+
+
+/**
+ * True if `item` is one of the
+ * comma-separated values in `list`.
+ */
+static bool contains_item(const std::string & list, const std::string & item) {
+    std::stringstream stream{list};
+    std::string it;
+
+    while (std::getline(stream, it, ',')) {
+        if (it == item) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * Finds the cgroup v2 hierarchy (if `is_v2`)
+ * or the v1 one with the cpu controller.
+ */
+static std::optional<CgroupMount> find_cgroup_mount(bool is_v2) {
+    // "<id> <parent> <device> <root> <point> <options> [tags] - <type> <source> <super options>"
+    std::ifstream file{"/proc/self/mountinfo"};
+    std::string line;
+
+    while (std::getline(file, line)) {
+        std::stringstream stream{line};
+        std::string id, parent, device, root, point, it;
+        stream >> id >> parent >> device >> root >> point;
+
+        while (stream >> it && it != "-") {}
+
+        std::string type, source, options;
+        stream >> type >> source >> options;
+
+        if (is_v2 ? type == "cgroup2" : type == "cgroup" && contains_item(options, "cpu")) {
+            return CgroupMount{root, point};
+        }
+    }
+
+    return {};
+}
+
+
+/**
+ * Returns the cgroup of this process in the v2
+ * hierarchy (if `is_v2`) or in the v1 one with
+ * the cpu controller.
+ */
+static std::optional<std::string> find_own_cgroup(bool is_v2) {
+    // "<id>:<controllers>:<path>", v2 has "0::<path>"
+    std::ifstream file{"/proc/self/cgroup"};
+    std::string line;
+
+    while (std::getline(file, line)) {
+        auto first = line.find(':');
+        auto second = line.find(':', first + 1);
+
+        if (first == std::string::npos || second == std::string::npos) {
+            continue;
+        }
+
+        auto controllers = line.substr(first + 1, second - first - 1);
+
+        if (is_v2 ? line.compare(0, first, "0") == 0 && controllers.empty() : contains_item(controllers, "cpu")) {
+            return line.substr(second + 1);
+        }
+    }
+
+    return {};
+}
+
+
+/**
+ * Returns the number of CPUs the quota in
+ * `directory` allows or 0 if there's none.
+ */
+static double read_cgroup_quota(const std::string & directory, bool is_v2) {
+    if (is_v2) {
+        // "<quota> <period>" or "max <period>"
+        std::ifstream file{directory + "/cpu.max"};
+        std::string quota;
+        double period = 0;
+
+        if (file >> quota >> period && quota != "max" && period > 0) {
+            return std::stod(quota) / period;
+        }
+
+        return 0;
+    }
+
+    // quota is -1 if not limited
+    std::ifstream quota_file{directory + "/cpu.cfs_quota_us"};
+    std::ifstream period_file{directory + "/cpu.cfs_period_us"};
+    double quota = 0;
+    double period = 0;
+
+    if (quota_file >> quota && period_file >> period && quota > 0 && period > 0) {
+        return quota / period;
+    }
+
+    return 0;
+}
+
+
+/**
+ * The smallest quota along the path from
+ * the process's cgroup up to the root of
+ * the hierarchy, since a parent limits
+ * all of its children.
+ */
+static double get_hierarchy_quota(bool is_v2) {
+    auto mount = find_cgroup_mount(is_v2);
+    auto path = find_own_cgroup(is_v2);
+
+    if (!mount || !path) {
+        return 0;
+    }
+
+    // the mount may only show a subtree, like
+    // in a container without a cgroup namespace
+    if (mount->root != "/" && path->compare(0, mount->root.size(), mount->root) == 0) {
+        *path = path->substr(mount->root.size());
+    }
+
+    if (!path->empty() && path->back() == '/') {
+        path->pop_back();
+    }
+
+    double minimum = 0;
+
+    while (true) {
+        auto quota = read_cgroup_quota(mount->point + *path, is_v2);
+
+        if (quota > 0 && (minimum == 0 || quota < minimum)) {
+            minimum = quota;
+        }
+
+        auto slash = path->find_last_of('/');
+
+        if (path->empty() || slash == std::string::npos) {
+            break;
+        }
+
+        path->resize(slash);
+    }
+
+    return minimum;
+}
+#endif
+
+
+/**
+ * Returns the number of CPUs the cgroup
+ * quota allows or 0 if there's no quota.
+ */
+static int get_cgroup_quota() {
+#if defined(__linux__)
+    // in hybrid setups the cpu controller may
+    // be in either of the hierarchies
+    double minimum = 0;
+
+    for (bool is_v2 : {true, false}) {
+        auto quota = get_hierarchy_quota(is_v2);
+
+        if (quota > 0 && (minimum == 0 || quota < minimum)) {
+            minimum = quota;
+        }
+    }
+
+    return (int) std::ceil(minimum);
+#else
+    return 0;
+#endif
+}
+
+
+std::vector<int> threading::get_available_cpus() {
+    std::vector<int> cpus;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int it = 0; it < CPU_SETSIZE; it++) {
+            if (CPU_ISSET(it, &set)) {
+                cpus.push_back(it);
+            }
+        }
+    }
+#elif defined(_WIN32)
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        for (int it = 0; it < (int) sizeof(DWORD_PTR) * 8; it++) {
+            if (process_mask & ((DWORD_PTR) 1 << it)) {
+                cpus.push_back(it);
+            }
+        }
+    }
+#endif
+
+    return cpus;
+}
+
+
+int threading::get_available_concurrency() {
+    int count = (int) get_available_cpus().size();
+
+    if (count == 0) {
+        count = (int) std::thread::hardware_concurrency();
+    }
+
+    auto quota = get_cgroup_quota();
+
+    if (quota > 0 && quota < count) {
+        count = quota;
+    }
+
+    if (count <= 0) {
+        count = 1;
+    }
+
+    return count;
+}
+
+
+bool threading::pin_thread(std::thread & thread, int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    auto handle = (HANDLE) thread.native_handle();
+    return SetThreadAffinityMask(handle, (DWORD_PTR) 1 << cpu) != 0;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,34 @@
+// Copyright (C) 2020 luna_koly
+//
+// Queries about the amount of hardware
+// the process is actually allowed to use.
+
+
+#pragma once
+
+#include <vector>
+#include <thread>
+
+
+namespace threading {
+    /**
+     * Returns the indices of the CPUs the
+     * process affinity mask allows to run on.
+     * Empty if the platform doesn't tell.
+     */
+    std::vector<int> get_available_cpus();
+
+    /**
+     * Returns the number of workers it makes
+     * sense to run: the affinity mask size
+     * limited by the cgroup CPU quota if any.
+     * Falls back to the hardware concurrency.
+     */
+    int get_available_concurrency();
+
+    /**
+     * Binds the thread to the single CPU.
+     * Returns false if that's not possible.
+     */
+    bool pin_thread(std::thread & thread, int cpu);
+}
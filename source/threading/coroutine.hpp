@@ -0,0 +1,421 @@
+// Copyright (C) 2020 luna_koly
+//
+// Coroutine tasks running on the ThreadPool.
+// A Task<T> is lazy: it starts when awaited
+// and resumes its awaiter when finished, so
+// waiting on subtasks suspends instead of
+// blocking a worker.
+
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <coroutine>
+#include <type_traits>
+#include <condition_variable>
+
+#include "thread_pool.hpp"
+
+
+namespace threading {
+    template <typename T = void>
+    class Task;
+
+    namespace details {
+        /**
+         * The part of the promise that
+         * doesn't depend on T.
+         */
+        struct PromiseBase {
+            /**
+             * Whoever awaits the task.
+             */
+            std::coroutine_handle<> continuation = std::noop_coroutine();
+
+            /**
+             * Resumes the awaiter right away
+             * (symmetric transfer, no recursion).
+             */
+            struct FinalAwaiter {
+                bool await_ready() noexcept {
+                    return false;
+                }
+
+                template <typename P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+                    return handle.promise().continuation;
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            FinalAwaiter final_suspend() noexcept {
+                return {};
+            }
+
+            void unhandled_exception() {
+                std::terminate();
+            }
+        };
+
+        /**
+         * Stores the result of the task.
+         */
+        template <typename T>
+        struct ValuePromise : public PromiseBase {
+            std::optional<T> value;
+
+            void return_value(T it) {
+                value.emplace(std::move(it));
+            }
+
+            T take() {
+                return std::move(*value);
+            }
+        };
+
+        template <>
+        struct ValuePromise<void> : public PromiseBase {
+            void return_void() {}
+
+            void take() {}
+        };
+
+        /**
+         * `void` can't be stored, so
+         * a placeholder is used instead.
+         */
+        template <typename T>
+        using Slot = std::conditional_t<std::is_void_v<T>, char, T>;
+
+        /**
+         * A one-shot flag a thread may block on.
+         */
+        struct Event {
+            std::mutex protector;
+            std::condition_variable notifier;
+            bool is_set = false;
+
+            void set() {
+                std::lock_guard lock(protector);
+                is_set = true;
+                notifier.notify_all();
+            }
+
+            void wait() {
+                std::unique_lock lock(protector);
+                notifier.wait(lock, [&]() {
+                    return is_set;
+                });
+            }
+        };
+
+        /**
+         * A coroutine that sets the event when it
+         * finishes and stays suspended so that the
+         * owner can destroy it afterwards.
+         */
+        struct SyncWaiter {
+            struct promise_type {
+                Event * event = nullptr;
+
+                SyncWaiter get_return_object() {
+                    return SyncWaiter{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept {
+                    return {};
+                }
+
+                auto final_suspend() noexcept {
+                    struct Awaiter {
+                        bool await_ready() noexcept {
+                            return false;
+                        }
+
+                        void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                            handle.promise().event->set();
+                        }
+
+                        void await_resume() noexcept {}
+                    };
+
+                    return Awaiter{};
+                }
+
+                void return_void() {}
+
+                void unhandled_exception() {
+                    std::terminate();
+                }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        template <typename T>
+        SyncWaiter run_sync_waiter(Task<T> & task, std::optional<Slot<T>> & result) {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+            } else {
+                result.emplace(co_await task);
+            }
+        }
+
+        /**
+         * Shared by all subtasks of a single `when_all`.
+         */
+        struct WhenAllState {
+            /**
+             * Subtasks left + 1 for the awaiter itself.
+             */
+            std::atomic<size_t> remaining;
+            std::coroutine_handle<> continuation;
+        };
+
+        /**
+         * Awaits a single subtask, then destroys
+         * itself and resumes the awaiter of
+         * `when_all` if it was the last one.
+         */
+        struct WhenAllHelper {
+            struct promise_type {
+                WhenAllState * state = nullptr;
+
+                WhenAllHelper get_return_object() {
+                    return WhenAllHelper{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+
+                std::suspend_always initial_suspend() noexcept {
+                    return {};
+                }
+
+                auto final_suspend() noexcept {
+                    struct Awaiter {
+                        bool await_ready() noexcept {
+                            return false;
+                        }
+
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                            auto state = handle.promise().state;
+                            handle.destroy();
+
+                            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                                return state->continuation;
+                            }
+
+                            return std::noop_coroutine();
+                        }
+
+                        void await_resume() noexcept {}
+                    };
+
+                    return Awaiter{};
+                }
+
+                void return_void() {}
+
+                void unhandled_exception() {
+                    std::terminate();
+                }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        template <typename T>
+        WhenAllHelper run_when_all_helper(Task<T> & task, std::optional<Slot<T>> & result) {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+            } else {
+                result.emplace(co_await task);
+            }
+        }
+
+        /**
+         * The awaitable returned by `when_all`.
+         */
+        template <typename T>
+        struct WhenAll {
+            std::vector<Task<T>> tasks;
+            std::vector<std::optional<Slot<T>>> results;
+            WhenAllState state;
+
+            WhenAll(std::vector<Task<T>> && tasks)
+                : tasks(std::move(tasks))
+                , results(this->tasks.size()) {
+                state.remaining = this->tasks.size() + 1;
+            }
+
+            bool await_ready() noexcept {
+                return tasks.empty();
+            }
+
+            bool await_suspend(std::coroutine_handle<> continuation) {
+                state.continuation = continuation;
+
+                for (size_t it = 0; it < tasks.size(); it++) {
+                    auto helper = run_when_all_helper(tasks[it], results[it]);
+                    helper.handle.promise().state = &state;
+                    helper.handle.resume();
+                }
+
+                // if every subtask has already finished,
+                // don't suspend at all
+                return state.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+            }
+
+            auto await_resume() {
+                if constexpr (std::is_void_v<T>) {
+                    return;
+                } else {
+                    std::vector<T> values;
+                    values.reserve(results.size());
+
+                    for (auto & it : results) {
+                        values.push_back(std::move(*it));
+                    }
+
+                    return values;
+                }
+            }
+        };
+    }
+
+    /**
+     * A lazy coroutine producing T.
+     */
+    template <typename T>
+    class Task {
+    public:
+        struct promise_type : public details::ValuePromise<T> {
+            Task get_return_object() {
+                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+        };
+
+        Task(Task && other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+        Task & operator = (Task && other) noexcept {
+            if (this != &other) {
+                if (handle) {
+                    handle.destroy();
+                }
+
+                handle = std::exchange(other.handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        Task(const Task &) = delete;
+        Task & operator = (const Task &) = delete;
+
+        ~Task() {
+            if (handle) {
+                handle.destroy();
+            }
+        }
+
+        /**
+         * Starts the task and suspends the
+         * awaiter until the task finishes.
+         */
+        auto operator co_await () noexcept {
+            struct Awaiter {
+                std::coroutine_handle<promise_type> handle;
+
+                /**
+                 * Moved-from tasks may not
+                 * be awaited.
+                 */
+                bool await_ready() noexcept {
+                    return handle.done();
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+                    handle.promise().continuation = continuation;
+                    return handle;
+                }
+
+                T await_resume() {
+                    return handle.promise().take();
+                }
+            };
+
+            return Awaiter{handle};
+        }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    /**
+     * `co_await resume_on(pool)` moves the rest of the
+     * coroutine to a pool worker. Does nothing if
+     * `pool` is nullptr.
+     */
+    inline auto resume_on(ThreadPool * pool) noexcept {
+        struct Awaiter {
+            ThreadPool * pool;
+
+            bool await_ready() noexcept {
+                return pool == nullptr;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                pool->schedule([handle]() {
+                    handle.resume();
+                });
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        return Awaiter{pool};
+    }
+
+    /**
+     * Runs all the tasks concurrently (as far as
+     * they `resume_on` some pool) and resumes the
+     * awaiter once all are done. Results keep
+     * the order of `tasks`.
+     */
+    template <typename T>
+    details::WhenAll<T> when_all(std::vector<Task<T>> tasks) {
+        return details::WhenAll<T>{std::move(tasks)};
+    }
+
+    /**
+     * Blocks the calling thread until the task
+     * finishes. Meant for the top level only,
+     * never call it from inside a pool task.
+     */
+    template <typename T>
+    T sync_wait(Task<T> task) {
+        details::Event event;
+        std::optional<details::Slot<T>> result;
+
+        auto waiter = details::run_sync_waiter(task, result);
+        waiter.handle.promise().event = &event;
+        waiter.handle.resume();
+
+        event.wait();
+        waiter.handle.destroy();
+
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*result);
+        }
+    }
+}
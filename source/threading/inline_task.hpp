@@ -0,0 +1,144 @@
+// Copyright (C) 2020 luna_koly
+//
+// A move-only `void()` callable that keeps
+// small closures inside itself instead of
+// allocating them on the heap.
+
+
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+
+namespace threading {
+    /**
+     * Stores any `void()` callable. Closures that
+     * fit into `capacity` bytes live inline,
+     * bigger ones fall back to the heap.
+     */
+    template <size_t capacity = 64>
+    class InlineTask {
+    public:
+        InlineTask() = default;
+
+        InlineTask(std::nullptr_t) {}
+
+        template <typename F>
+            requires (!std::is_same_v<std::decay_t<F>, InlineTask>)
+        InlineTask(F && function) {
+            using Callable = std::decay_t<F>;
+
+            if constexpr (fits_inline<Callable>) {
+                new (storage) Callable(std::forward<F>(function));
+                operations = &inline_operations<Callable>;
+            } else {
+                new (storage) Callable * (new Callable(std::forward<F>(function)));
+                operations = &heap_operations<Callable>;
+            }
+        }
+
+        InlineTask(InlineTask && other) noexcept {
+            take(std::move(other));
+        }
+
+        InlineTask & operator = (InlineTask && other) noexcept {
+            if (this != &other) {
+                reset();
+                take(std::move(other));
+            }
+
+            return *this;
+        }
+
+        InlineTask(const InlineTask &) = delete;
+        InlineTask & operator = (const InlineTask &) = delete;
+
+        ~InlineTask() {
+            reset();
+        }
+
+        void operator () () {
+            operations->invoke(storage);
+        }
+
+        explicit operator bool () const {
+            return operations != nullptr;
+        }
+
+    private:
+        /**
+         * Hand-made vtable of the stored callable.
+         */
+        struct Operations {
+            void (*invoke)(void * storage);
+            /**
+             * Move-constructs the callable into `target`
+             * and destroys the `source` one.
+             */
+            void (*relocate)(void * source, void * target);
+            void (*destroy)(void * storage);
+        };
+
+        template <typename Callable>
+        static constexpr bool fits_inline =
+            sizeof(Callable) <= capacity &&
+            alignof(Callable) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<Callable>;
+
+        template <typename Callable>
+        static constexpr Operations inline_operations = {
+            .invoke = [](void * storage) {
+                (*static_cast<Callable *>(storage))();
+            },
+            .relocate = [](void * source, void * target) {
+                auto it = static_cast<Callable *>(source);
+                new (target) Callable(std::move(*it));
+                it->~Callable();
+            },
+            .destroy = [](void * storage) {
+                static_cast<Callable *>(storage)->~Callable();
+            }
+        };
+
+        template <typename Callable>
+        static constexpr Operations heap_operations = {
+            .invoke = [](void * storage) {
+                (**static_cast<Callable **>(storage))();
+            },
+            .relocate = [](void * source, void * target) {
+                new (target) Callable * (*static_cast<Callable **>(source));
+            },
+            .destroy = [](void * storage) {
+                delete *static_cast<Callable **>(storage);
+            }
+        };
+
+        /**
+         * Either the callable itself or
+         * a pointer to it.
+         */
+        alignas(std::max_align_t) unsigned char storage[capacity < sizeof(void *) ? sizeof(void *) : capacity];
+        /**
+         * nullptr if empty.
+         */
+        const Operations * operations = nullptr;
+
+        void take(InlineTask && other) {
+            if (other.operations != nullptr) {
+                other.operations->relocate(other.storage, storage);
+                operations = other.operations;
+                other.operations = nullptr;
+            }
+        }
+
+        void reset() {
+            if (operations != nullptr) {
+                operations->destroy(storage);
+                operations = nullptr;
+            }
+        }
+    };
+}
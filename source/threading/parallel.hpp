@@ -0,0 +1,211 @@
+// Copyright (C) 2020 luna_koly
+//
+// Data-parallel loops on top of the ThreadPool.
+
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <condition_variable>
+
+#include "thread_pool.hpp"
+
+
+namespace threading {
+    namespace details {
+        /**
+         * Shared between the caller and the
+         * helper tasks of a single loop.
+         */
+        struct ParallelState {
+            /**
+             * The next chunk to be claimed.
+             */
+            std::atomic<size_t> next_chunk = 0;
+            /**
+             * The total number of chunks.
+             */
+            size_t chunks_count = 0;
+            /**
+             * Chunks that have been processed.
+             */
+            size_t finished_chunks = 0;
+            /**
+             * Locked when accessing `finished_chunks`.
+             */
+            std::mutex protector;
+            /**
+             * Used to notify the caller that
+             * all chunks have been processed.
+             */
+            std::condition_variable notifier;
+        };
+
+        /**
+         * Picks the chunk size if the user
+         * didn't specify one: a few chunks
+         * per worker so that they balance.
+         */
+        inline size_t choose_grain(ThreadPool * pool, size_t count, size_t grain) {
+            if (grain != 0) {
+                return grain;
+            }
+
+            if (pool == nullptr) {
+                return count > 0 ? count : 1;
+            }
+
+            return std::max<size_t>(1, count / (pool->get_workers_count() * 4));
+        }
+
+        /**
+         * Claims and processes chunks until none
+         * left, then reports how many were done.
+         */
+        template <typename F>
+        void run_chunks(ParallelState & state, size_t begin, size_t end, size_t grain, F & function) {
+            size_t processed = 0;
+
+            while (true) {
+                auto chunk = state.next_chunk.fetch_add(1);
+
+                if (chunk >= state.chunks_count) {
+                    break;
+                }
+
+                auto from = begin + chunk * grain;
+                auto to = std::min(end, from + grain);
+                function(chunk, from, to);
+                processed += 1;
+            }
+
+            if (processed > 0) {
+                std::lock_guard lock(state.protector);
+                state.finished_chunks += processed;
+
+                if (state.finished_chunks == state.chunks_count) {
+                    state.notifier.notify_all();
+                }
+            }
+        }
+
+        /**
+         * Splits [begin, end) into chunks of `grain`
+         * and calls `function(chunk, from, to)` for each.
+         * The caller processes chunks too, so this
+         * is safe to call from inside a task.
+         */
+        template <typename F>
+        void parallel_chunks(ThreadPool * pool, size_t begin, size_t end, size_t grain, F && function) {
+            if (end <= begin) {
+                return;
+            }
+
+            auto chunks_count = (end - begin + grain - 1) / grain;
+
+            if (pool == nullptr || chunks_count == 1) {
+                for (size_t chunk = 0; chunk < chunks_count; chunk++) {
+                    auto from = begin + chunk * grain;
+                    function(chunk, from, std::min(end, from + grain));
+                }
+
+                return;
+            }
+
+            auto state = std::make_shared<ParallelState>();
+            state->chunks_count = chunks_count;
+
+            auto helpers_count = std::min(pool->get_workers_count(), chunks_count - 1);
+
+            for (size_t it = 0; it < helpers_count; it++) {
+                // helpers that start late find nothing
+                // to claim and never touch `function`
+                pool->schedule([state, begin, end, grain, &function]() {
+                    run_chunks(*state, begin, end, grain, function);
+                });
+            }
+
+            run_chunks(*state, begin, end, grain, function);
+
+            std::unique_lock lock(state->protector);
+
+            state->notifier.wait(lock, [&]() {
+                return state->finished_chunks == state->chunks_count;
+            });
+        }
+    }
+
+    /**
+     * Calls `function(index)` for every index
+     * in [begin, end), `grain` indices per task.
+     * `grain == 0` picks it automatically, and
+     * `pool == nullptr` runs everything in place.
+     */
+    template <typename F>
+    void parallel_for(ThreadPool * pool, size_t begin, size_t end, size_t grain, F && function) {
+        grain = details::choose_grain(pool, end - begin, grain);
+
+        details::parallel_chunks(pool, begin, end, grain, [&](size_t chunk, size_t from, size_t to) {
+            for (size_t it = from; it < to; it++) {
+                function(it);
+            }
+        });
+    }
+
+    /**
+     * Calls `function(item)` for every item
+     * of the random-access range.
+     */
+    template <typename R, typename F>
+    void parallel_for(ThreadPool * pool, R & range, size_t grain, F && function) {
+        auto first = std::begin(range);
+
+        parallel_for(pool, 0, std::size(range), grain, [&](size_t it) {
+            function(first[it]);
+        });
+    }
+
+    /**
+     * Maps every index in [begin, end) via
+     * `map(index)` and folds the results with
+     * `combine(left, right)` starting from
+     * `identity`. Chunk results are combined
+     * in the index order, so the result is the
+     * same regardless of scheduling.
+     */
+    template <typename T, typename M, typename C>
+    T parallel_reduce(ThreadPool * pool, size_t begin, size_t end, size_t grain, T identity, M && map, C && combine) {
+        if (end <= begin) {
+            return identity;
+        }
+
+        grain = details::choose_grain(pool, end - begin, grain);
+
+        auto chunks_count = (end - begin + grain - 1) / grain;
+        std::vector<T> partials(chunks_count, identity);
+
+        details::parallel_chunks(pool, begin, end, grain, [&](size_t chunk, size_t from, size_t to) {
+            T value = identity;
+
+            for (size_t it = from; it < to; it++) {
+                value = combine(std::move(value), map(it));
+            }
+
+            partials[chunk] = std::move(value);
+        });
+
+        T result = identity;
+
+        for (auto & it : partials) {
+            result = combine(std::move(result), std::move(it));
+        }
+
+        return result;
+    }
+}
@@ -1,29 +1,94 @@
 #include "thread_pool.hpp"
 
 #include <iostream>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
 
 
 using namespace threading;
 
 
-ThreadPool::ThreadPool(int workers_count) {
+/**
+ * Tells the CPU we're in a spin loop
+ * without giving up the time slice.
+ */
+static inline void relax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+
+/**
+ * Raises `maximum` to `value` if it's lower.
+ */
+template <typename T>
+static void update_maximum(std::atomic<T> & maximum, T value) {
+    auto current = maximum.load(std::memory_order_relaxed);
+
+    while (
+        current < value &&
+        !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)
+    ) {}
+}
+
+
+/**
+ * Nanoseconds since the clock's epoch,
+ * never 0 for a real point.
+ */
+static int64_t get_timestamp(std::chrono::steady_clock::time_point point) {
+    return std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(point.time_since_epoch()).count());
+}
+
+/**
+ * Nanoseconds between the two points.
+ */
+static int64_t nanoseconds_between(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point stop) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+}
+
+
+ThreadPool::ThreadPool(int workers_count, bool pin_workers, bool collect_metrics)
+    : collect_metrics(collect_metrics) {
     if (workers_count == 0) {
         workers_count = 1;
     }
 
     // std::cout << "//Starting a pool with " << workers_count << " workers//" << std::endl;
 
-    busy_workers_count = workers_count;
+    if (collect_metrics) {
+        worker_counters = std::make_unique<WorkerCounters[]>(workers_count);
+    }
 
     for (size_t it = 0; it < workers_count; it++) {
         // `ThreadPool::` is required here
-        workers.push_back(std::thread(&ThreadPool::process, this));
+        workers.push_back(std::thread(&ThreadPool::process, this, it));
+    }
+
+    if (pin_workers) {
+        auto cpus = get_available_cpus();
+
+        for (size_t it = 0; it < workers.size() && !cpus.empty(); it++) {
+            pin_thread(workers[it], cpus[it % cpus.size()]);
+        }
     }
 }
 
 
 ThreadPool::~ThreadPool() {
-    should_stop = true;
+    {
+        // under the lock so that a worker that is
+        // just about to park doesn't miss the event
+        std::lock_guard lock(parking_protector);
+        should_stop = true;
+    }
+
     notifier.notify_all();
 
     for (auto & it : workers) {
@@ -34,75 +99,218 @@ ThreadPool::~ThreadPool() {
 }
 
 
-void ThreadPool::schedule(Task task) {
-    std::lock_guard lock(tasks_protector);
-    tasks.push(task);
-    notifier.notify_one();
+void ThreadPool::schedule(Task && task) {
+    unfinished_tasks_count += 1;
+    // counted before pushing so that a worker
+    // popping it right away never sees it negative
+    auto depth = queued_tasks_count.fetch_add(1) + 1;
+
+    Entry entry{std::move(task), {}};
+
+    if (collect_metrics) {
+        tasks_scheduled += 1;
+        update_maximum(max_queue_depth, depth);
+        entry.scheduled_at = Clock::now();
+    }
+
+    if (!tasks.try_push(std::move(entry))) {
+        // the queue is full, so the caller
+        // does the job itself
+        queued_tasks_count -= 1;
+
+        if (collect_metrics) {
+            tasks_run_in_place += 1;
+        }
+
+        entry.task();
+        finish_task();
+        return;
+    }
+
+    // pairs with the increment in `take()`:
+    // either the worker sees the task or
+    // we see the worker parked
+    if (parked_workers_count > 0) {
+        std::lock_guard lock(parking_protector);
+        notifier.notify_one();
+    }
 }
 
 
-// void ThreadPool::process() {
-//     while (true) {
-//         Task task = nullptr;
+bool ThreadPool::try_take(Entry & entry) {
+    if (tasks.try_pop(entry)) {
+        queued_tasks_count -= 1;
+        return true;
+    }
 
-//         {
-//             std::unique_lock lock(tasks_protector);
+    return false;
+}
 
-//             notifier.wait(lock, [&]() {
-//                 return !tasks.empty() || should_stop;
-//             });
 
-//             // this is not the same as `should_stop`
-//             // because we may still have something in the queue
-//             // and `should_stop == true` at the same time
-//             if (tasks.empty()) {
-//                 break;
-//             }
+bool ThreadPool::take(size_t worker, Entry & entry) {
+    for (int it = 0; it < SPIN_COUNT; it++) {
+        if (should_stop) {
+            return false;
+        }
+
+        if (try_take(entry)) {
+            return true;
+        }
+
+        relax();
+    }
 
-//             task = tasks.front();
-//             tasks.pop();
-//         }
+    std::unique_lock lock(parking_protector);
 
-//         task();
-//     }
-// }
+    while (true) {
+        if (should_stop) {
+            return false;
+        }
 
-void ThreadPool::process() {
-    while (!should_stop) {
-        Task task = nullptr;
+        if (try_take(entry)) {
+            return true;
+        }
 
-        {
-            std::unique_lock lock(tasks_protector);
+        // `schedule()` counts the task right before
+        // pushing it, don't hold the lock meanwhile,
+        // the producer needs it to notify
+        if (queued_tasks_count > 0) {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+            continue;
+        }
 
-            busy_workers_count -= 1;
+        parked_workers_count += 1;
 
-            if (tasks.empty() && busy_workers_count == 0) {
-                all_tasks_processed_notifier.notify_all();
-            }
+        notifier.wait(lock, [&]() {
+            return queued_tasks_count > 0 || should_stop;
+        });
 
-            notifier.wait(lock, [&]() {
-                return !tasks.empty() || should_stop;
-            });
+        parked_workers_count -= 1;
 
-            if (should_stop) {
-                break;
+        if (collect_metrics) {
+            worker_counters[worker].wake_ups += 1;
+        }
+    }
+}
+
+
+void ThreadPool::finish_task() {
+    if (unfinished_tasks_count.fetch_sub(1) == 1) {
+        std::lock_guard lock(waiting_protector);
+        all_tasks_processed_notifier.notify_all();
+    }
+}
+
+
+void ThreadPool::end_idle_period(size_t worker, Clock::time_point now) {
+    auto & counters = worker_counters[worker];
+    auto since = counters.idle_since.exchange(0);
+
+    if (since != 0) {
+        counters.idle_nanoseconds += std::max<int64_t>(0, get_timestamp(now) - since);
+    }
+}
+
+
+void ThreadPool::process(size_t worker) {
+    Entry entry;
+
+    while (true) {
+        if (collect_metrics) {
+            worker_counters[worker].idle_since = get_timestamp(Clock::now());
+        }
+
+        if (!take(worker, entry)) {
+            if (collect_metrics) {
+                end_idle_period(worker, Clock::now());
             }
 
-            busy_workers_count += 1;
+            break;
+        }
+
+        busy_workers_count += 1;
+
+        if (collect_metrics) {
+            auto busy_start = Clock::now();
+            auto & counters = worker_counters[worker];
+            auto queue_time = nanoseconds_between(entry.scheduled_at, busy_start);
+
+            end_idle_period(worker, busy_start);
+            total_queue_nanoseconds += queue_time;
+            update_maximum(max_queue_nanoseconds, queue_time);
+
+            entry.task();
 
-            task = tasks.front();
-            tasks.pop();
+            counters.busy_nanoseconds += nanoseconds_between(busy_start, Clock::now());
+            counters.tasks_executed += 1;
+        } else {
+            entry.task();
         }
 
-        task();
+        // release the closure before reporting
+        // so that its captures don't outlive `wait()`
+        entry.task = nullptr;
+        busy_workers_count -= 1;
+
+        finish_task();
     }
 }
 
 
 void ThreadPool::wait() {
-    std::unique_lock lock(tasks_protector);
+    std::unique_lock lock(waiting_protector);
 
     all_tasks_processed_notifier.wait(lock, [&]() {
-        return tasks.empty() && busy_workers_count == 0;
+        return unfinished_tasks_count == 0;
     });
 }
+
+
+size_t ThreadPool::get_workers_count() const {
+    return workers.size();
+}
+
+
+bool ThreadPool::is_collecting_metrics() const {
+    return collect_metrics;
+}
+
+
+ThreadPool::Metrics ThreadPool::get_metrics() const {
+    Metrics metrics;
+
+    if (!collect_metrics) {
+        return metrics;
+    }
+
+    auto now = get_timestamp(Clock::now());
+
+    for (size_t it = 0; it < workers.size(); it++) {
+        auto & counters = worker_counters[it];
+        auto idle_nanoseconds = counters.idle_nanoseconds.load();
+        auto since = counters.idle_since.load();
+
+        // the worker may be waiting for
+        // a task that never comes
+        if (since != 0) {
+            idle_nanoseconds += std::max<int64_t>(0, now - since);
+        }
+
+        metrics.workers.push_back(WorkerMetrics{
+            .tasks_executed = counters.tasks_executed,
+            .busy_time = std::chrono::nanoseconds(counters.busy_nanoseconds),
+            .idle_time = std::chrono::nanoseconds(idle_nanoseconds),
+            .wake_ups = counters.wake_ups
+        });
+    }
+
+    metrics.tasks_scheduled = tasks_scheduled;
+    metrics.tasks_run_in_place = tasks_run_in_place;
+    metrics.max_queue_depth = max_queue_depth;
+    metrics.total_queue_time = std::chrono::nanoseconds(total_queue_nanoseconds);
+    metrics.max_queue_time = std::chrono::nanoseconds(max_queue_nanoseconds);
+
+    return metrics;
+}
@@ -5,12 +5,18 @@
 
 #pragma once
 
-#include <queue>
 #include <mutex>
+#include <chrono>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <thread>
 #include <condition_variable>
-#include <functional>
+#include <utility>
+
+#include "concurrency.hpp"
+#include "inline_task.hpp"
+#include "bounded_queue.hpp"
 
 
 namespace threading {
@@ -22,27 +28,156 @@ namespace threading {
     public:
         /**
          * The general form of a task.
+         * Small closures don't allocate.
          */
         // using Task = void (*)();
-        using Task = std::function<void()>;
+        using Task = InlineTask<>;
+
+        /**
+         * What a single worker has been doing.
+         */
+        struct WorkerMetrics {
+            /**
+             * Tasks this worker has run.
+             */
+            size_t tasks_executed = 0;
+            /**
+             * Time spent inside tasks.
+             */
+            std::chrono::nanoseconds busy_time{0};
+            /**
+             * Time spent looking for a task
+             * (spinning or parked).
+             */
+            std::chrono::nanoseconds idle_time{0};
+            /**
+             * Times the worker has been woken
+             * up after parking.
+             */
+            size_t wake_ups = 0;
+        };
 
+        /**
+         * What the pool has been doing. Only
+         * collected if requested on construction.
+         */
+        struct Metrics {
+            std::vector<WorkerMetrics> workers;
+            /**
+             * Tasks passed to `schedule()`.
+             */
+            size_t tasks_scheduled = 0;
+            /**
+             * Tasks the scheduling thread had to run
+             * itself because the queue was full.
+             */
+            size_t tasks_run_in_place = 0;
+            /**
+             * The largest number of tasks
+             * waiting in the queue at once.
+             */
+            size_t max_queue_depth = 0;
+            /**
+             * Time tasks have spent in the
+             * queue before a worker took them.
+             */
+            std::chrono::nanoseconds total_queue_time{0};
+            std::chrono::nanoseconds max_queue_time{0};
+        };
+
+        /**
+         * The maximum number of queued tasks.
+         * When the queue is full, `schedule()`
+         * runs the task in place.
+         */
+        static const size_t QUEUE_CAPACITY = 1024;
+        /**
+         * How many times an idle worker polls
+         * the queue before going to sleep.
+         */
+        static const int SPIN_COUNT = 256;
+
+        /**
+         * If `pin_workers` is true, each worker
+         * is bound to its own available CPU.
+         * If `collect_metrics` is true, the pool
+         * keeps counters for `get_metrics()`.
+         */
         ThreadPool(
-            int workers_count = std::thread::hardware_concurrency()
+            int workers_count = get_available_concurrency(),
+            bool pin_workers = false,
+            bool collect_metrics = false
         );
 
         ~ThreadPool();
 
         /**
          * Adds the task to the inner queue.
+         * Doesn't lock and only notifies if
+         * some worker is asleep.
          */
-        void schedule(Task task);
+        void schedule(Task && task);
 
         /**
-         * Blocks until the tasks queue is empty.
+         * Wraps the callable into a Task
+         * in place and schedules it.
+         */
+        template <typename F>
+            requires (!std::is_same_v<std::decay_t<F>, Task>)
+        void schedule(F && function) {
+            schedule(Task(std::forward<F>(function)));
+        }
+
+        /**
+         * Blocks until the tasks queue is empty
+         * and no worker is busy.
          */
         void wait();
 
+        /**
+         * Returns the number of workers.
+         */
+        size_t get_workers_count() const;
+
+        /**
+         * True if the pool keeps metrics.
+         */
+        bool is_collecting_metrics() const;
+
+        /**
+         * Returns a snapshot of the counters.
+         * Consistent after `wait()`. Empty if
+         * metrics are not collected.
+         */
+        Metrics get_metrics() const;
+
     private:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * A task with the time it was queued at.
+         */
+        struct Entry {
+            Task task;
+            Clock::time_point scheduled_at;
+        };
+
+        /**
+         * Per-worker counters, each on its
+         * own cache line.
+         */
+        struct alignas(64) WorkerCounters {
+            std::atomic<size_t> tasks_executed = 0;
+            std::atomic<int64_t> busy_nanoseconds = 0;
+            std::atomic<int64_t> idle_nanoseconds = 0;
+            /**
+             * When the current idle period has
+             * started, 0 while running a task.
+             */
+            std::atomic<int64_t> idle_since = 0;
+            std::atomic<size_t> wake_ups = 0;
+        };
+
         /**
          * The vector of available workers.
          */
@@ -50,33 +185,91 @@ namespace threading {
         /**
          * The unprocessed tasks.
          */
-        std::queue<Task> tasks;
+        BoundedQueue<Entry> tasks{QUEUE_CAPACITY};
         /**
-         * Locked when accessing the queue.
+         * The number of tasks in `tasks`. May be
+         * briefly ahead of the queue itself.
          */
-        std::mutex tasks_protector;
+        std::atomic<size_t> queued_tasks_count = 0;
+        /**
+         * Scheduled tasks that haven't
+         * finished yet (queued + running).
+         */
+        std::atomic<size_t> unfinished_tasks_count = 0;
         /**
          * The number of busy workers.
          */
-        int busy_workers_count = 0;
+        std::atomic<int> busy_workers_count = 0;
+        /**
+         * The number of workers sleeping
+         * on the `notifier`.
+         */
+        std::atomic<int> parked_workers_count = 0;
+        /**
+         * Locked when a worker goes to sleep
+         * or gets woken up.
+         */
+        std::mutex parking_protector;
         /**
-         * Used to distribute events about
-         * unprocessed tasks left.
+         * Used to wake up parked workers
+         * when new tasks arrive.
          */
         std::condition_variable notifier;
         /**
          * True on destruction.
          */
-        bool should_stop = false;
+        std::atomic<bool> should_stop = false;
+        /**
+         * Locked when waiting for all
+         * tasks to be processed.
+         */
+        std::mutex waiting_protector;
         /**
          * Used to notify the user that
          * all tasks have been processed.
          */
         std::condition_variable all_tasks_processed_notifier;
+        /**
+         * Whether the counters below are updated.
+         */
+        const bool collect_metrics;
+        /**
+         * One per worker.
+         */
+        std::unique_ptr<WorkerCounters[]> worker_counters;
+        std::atomic<size_t> tasks_scheduled = 0;
+        std::atomic<size_t> tasks_run_in_place = 0;
+        std::atomic<size_t> max_queue_depth = 0;
+        std::atomic<int64_t> total_queue_nanoseconds = 0;
+        std::atomic<int64_t> max_queue_nanoseconds = 0;
+
+        /**
+         * Spins for a while, then parks until
+         * a task is available. Returns false
+         * if the pool is being destroyed.
+         */
+        bool take(size_t worker, Entry & entry);
+
+        /**
+         * Pops a task if there's one.
+         */
+        bool try_take(Entry & entry);
+
+        /**
+         * Marks a task as done and wakes up
+         * `wait()` if it was the last one.
+         */
+        void finish_task();
+
+        /**
+         * Adds the time since the worker has
+         * started waiting to its idle time.
+         */
+        void end_idle_period(size_t worker, Clock::time_point now);
 
         /**
          * Called by each single worker every time.
          */
-        void process();
+        void process(size_t worker);
     };
 }
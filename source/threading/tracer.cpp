@@ -0,0 +1,167 @@
+#include "tracer.hpp"
+
+#include <atomic>
+#include <fstream>
+
+
+using namespace threading;
+
+
+/**
+ * Escapes the text so that it can be placed
+ * inside a JSON string (Windows paths have `\`).
+ */
+static std::string escape_json(const std::string & text) {
+    std::string result;
+    result.reserve(text.size());
+
+    for (auto it : text) {
+        if (it == '"' || it == '\\') {
+            result += '\\';
+            result += it;
+        } else if (it == '\n') {
+            result += "\\n";
+        } else if (it == '\t') {
+            result += "\\t";
+        } else if ((unsigned char) it < 0x20) {
+            static const char * digits = "0123456789abcdef";
+            result += "\\u00";
+            result += digits[(it >> 4) & 0xF];
+            result += digits[it & 0xF];
+        } else {
+            result += it;
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * Distinguishes tracers even if one
+ * reuses the address of another.
+ */
+static std::atomic<size_t> last_tracer_id = 0;
+
+
+Tracer::Tracer() : id(++last_tracer_id), origin(std::chrono::steady_clock::now()) {
+    // the creating thread always comes first
+    get_buffer();
+}
+
+
+int64_t Tracer::now() const {
+    auto elapsed = std::chrono::steady_clock::now() - origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+
+Tracer::Buffer & Tracer::get_buffer() {
+    // a thread only ever talks to one tracer
+    // at a time, so remembering the owner is enough
+    thread_local size_t owner = 0;
+    thread_local Buffer * buffer = nullptr;
+
+    if (owner != id) {
+        std::lock_guard lock(buffers_protector);
+        buffers.push_back(std::make_unique<Buffer>());
+        buffer = buffers.back().get();
+        buffer->thread_index = buffers.size();
+        owner = id;
+    }
+
+    return *buffer;
+}
+
+
+void Tracer::record(Event && event) {
+    get_buffer().events.push_back(std::move(event));
+}
+
+
+bool Tracer::write(const std::string & filename) const {
+    std::ofstream file{filename};
+
+    if (file.fail()) {
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    bool is_first = true;
+
+    for (auto & buffer : buffers) {
+        if (!is_first) {
+            file << ",\n";
+        }
+
+        is_first = false;
+
+        file
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_index
+            << ",\"args\":{\"name\":\"" << (buffer->thread_index == 1 ? "main" : "worker") << "\"}}";
+
+        for (auto & event : buffer->events) {
+            file
+                << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1"
+                << ",\"tid\":" << buffer->thread_index
+                << ",\"ts\":" << event.start
+                << ",\"dur\":" << event.duration
+                << ",\"args\":{" << event.arguments << "}}";
+        }
+    }
+
+    file << "\n]}\n";
+    return !file.fail();
+}
+
+
+Span::Span(Tracer * tracer, const char * name) : tracer(tracer), name(name) {
+    if (tracer != nullptr) {
+        start = tracer->now();
+    }
+}
+
+
+Span::~Span() {
+    if (tracer != nullptr) {
+        tracer->record(Tracer::Event{
+            .name = name,
+            .arguments = std::move(arguments),
+            .start = start,
+            .duration = tracer->now() - start
+        });
+    }
+}
+
+
+void Span::append_key(const char * key) {
+    if (!arguments.empty()) {
+        arguments += ',';
+    }
+
+    arguments += '"';
+    arguments += key;
+    arguments += "\":";
+}
+
+
+Span & Span::argument(const char * key, const std::string & value) {
+    if (tracer != nullptr) {
+        append_key(key);
+        arguments += '"';
+        arguments += escape_json(value);
+        arguments += '"';
+    }
+
+    return *this;
+}
+
+
+Span & Span::argument(const char * key, int64_t value) {
+    if (tracer != nullptr) {
+        append_key(key);
+        arguments += std::to_string(value);
+    }
+
+    return *this;
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2020 luna_koly
+//
+// Records timed spans from many threads
+// and writes them in the Chrome trace-event
+// format (chrome://tracing, Perfetto).
+
+
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace threading {
+    /**
+     * Collects spans. Each thread appends to
+     * its own buffer, so recording doesn't lock.
+     */
+    class Tracer {
+    public:
+        /**
+         * A single finished span.
+         */
+        struct Event {
+            /**
+             * Must be a string literal.
+             */
+            const char * name;
+            /**
+             * Already rendered `"key": value` pairs.
+             */
+            std::string arguments;
+            /**
+             * Microseconds since the tracer creation.
+             */
+            int64_t start;
+            int64_t duration;
+        };
+
+        Tracer();
+
+        /**
+         * Appends the event to the buffer
+         * of the calling thread.
+         */
+        void record(Event && event);
+
+        /**
+         * Microseconds since the tracer creation.
+         */
+        int64_t now() const;
+
+        /**
+         * Writes all the recorded events as JSON.
+         * Must not race with `record()`.
+         * Returns false if the file can't be opened.
+         */
+        bool write(const std::string & filename) const;
+
+    private:
+        /**
+         * Events of a single thread.
+         */
+        struct Buffer {
+            size_t thread_index;
+            std::vector<Event> events;
+        };
+
+        /**
+         * Unique among all tracers.
+         */
+        const size_t id;
+        /**
+         * The time point all timestamps
+         * are relative to.
+         */
+        const std::chrono::steady_clock::time_point origin;
+        /**
+         * Every thread's buffer.
+         */
+        std::vector<std::unique_ptr<Buffer>> buffers;
+        /**
+         * Locked only when a thread records
+         * its first event.
+         */
+        std::mutex buffers_protector;
+
+        /**
+         * Returns the calling thread buffer,
+         * registers it on first use.
+         */
+        Buffer & get_buffer();
+    };
+
+    /**
+     * Records the time between its construction
+     * and destruction. Does nothing if the
+     * tracer is nullptr.
+     */
+    class Span {
+    public:
+        Span(Tracer * tracer, const char * name);
+
+        ~Span();
+
+        Span(const Span &) = delete;
+        Span & operator = (const Span &) = delete;
+
+        /**
+         * Attaches a string argument.
+         */
+        Span & argument(const char * key, const std::string & value);
+
+        /**
+         * Attaches a numeric argument.
+         */
+        Span & argument(const char * key, int64_t value);
+
+    private:
+        Tracer * tracer;
+        const char * name;
+        int64_t start = 0;
+        std::string arguments;
+
+        /**
+         * Starts a new `"key": ` pair.
+         */
+        void append_key(const char * key);
+    };
+}
@@ -13,6 +13,14 @@ cases = [
         'command': COMPILER_PATH + ' --std 1',
         # 'command': COMPILER_PATH + ' --std 1 --no-parallel',
     },
+    {
+        'directory': f'{SCRIPT_DIRECTORY}/streaming/',
+        'command': COMPILER_PATH + ' --std 1 --streaming',
+    },
+    {
+        'directory': f'{SCRIPT_DIRECTORY}/types/',
+        'command': COMPILER_PATH + ' --std 1 --print-types',
+    },
 ]
 
 
@@ -27,9 +35,20 @@ def remove_links(text):
     return text
 
 
+def get_inputs(case, input_file):
+    path = os.path.join(case['directory'], input_file)
+
+    # a directory is a single test
+    # made of all the files inside
+    if os.path.isdir(path):
+        return [os.path.join(path, it) for it in sorted(os.listdir(path)) if it.endswith('.in')]
+
+    return [path]
+
+
 def test(case, input_file):
     command = case['command'].split()
-    command.append(os.path.join(case["directory"], input_file))
+    command.extend(get_inputs(case, input_file))
     actual = subprocess.run(command, capture_output=True, text=True).stdout
     actual = remove_links(actual)
 
@@ -65,7 +84,7 @@ def run(case):
     total = 0
 
     for file in os.listdir(case['directory']):
-        if file.endswith('.in'):
+        if file.endswith('.in') or os.path.isdir(os.path.join(case['directory'], file)):
             total += 1
             is_good = test(case, file)
 